@@ -0,0 +1,154 @@
+#pragma once
+
+#include <string>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include "json_extract.hpp"
+#include "game_data.hpp"
+#include "http_client.hpp"
+
+// Fetches snapshots for many universes at once.
+// Both games endpoints accept a comma separated universeIds list, so the
+// watchlist is split into chunks of kMaxIdsPerRequest and every chunk costs
+// one games request and one votes request. The data[] entries are fanned
+// back out by their "id" field.
+class BatchFetcher {
+public:
+    static constexpr size_t kMaxIdsPerRequest = 100;
+
+    // ROBLOX_API_BASE points the fetcher at a stand-in server, e.g. http://127.0.0.1:8080
+    explicit BatchFetcher(std::string base = defaultBaseUrl()) : baseUrl(std::move(base)) {}
+
+    static std::string defaultBaseUrl() {
+        const char* env = std::getenv("ROBLOX_API_BASE");
+        return (env && *env) ? env : "https://games.roblox.com";
+    }
+
+    // Splits ids into comma separated chunks of at most kMaxIdsPerRequest
+    static std::vector<std::string> buildChunks(const std::vector<std::string>& ids) {
+        std::vector<std::string> chunks;
+        for (size_t i = 0; i < ids.size(); i += kMaxIdsPerRequest) {
+            std::string chunk;
+            size_t end = std::min(ids.size(), i + kMaxIdsPerRequest);
+            for (size_t j = i; j < end; j++) {
+                if (j > i) chunk += ',';
+                chunk += ids[j];
+            }
+            chunks.push_back(chunk);
+        }
+        return chunks;
+    }
+
+    // Games endpoint only: CCU, visits, favorites and metadata (snapshots
+    // without a playing count are marked failed but keep it). Ids whose
+    // request failed are appended to unanswered, so they can be told apart
+    // from ids the API does not know.
+    std::unordered_map<std::string, GameSnapshot> fetchGames(const std::vector<std::string>& ids,
+                                                             std::vector<std::string>* unanswered = nullptr) {
+        std::vector<size_t> failedChunks;
+        auto results = fetchChunks(buildChunks(ids), false, true, &failedChunks);
+        if (unanswered) {
+            for (size_t chunk : failedChunks) {
+                size_t end = std::min(ids.size(), (chunk + 1) * kMaxIdsPerRequest);
+                for (size_t i = chunk * kMaxIdsPerRequest; i < end; i++) unanswered->push_back(ids[i]);
+            }
+        }
+        return results;
+    }
+
+    // Games and votes endpoints. Metadata is only copied out of the games
+    // response when withMetadata is set. Ids missing from the games
+    // response are left out of the map, even if their votes arrived; ids
+    // missing from the votes response keep hasVotes unset.
+    std::unordered_map<std::string, GameSnapshot> fetch(const std::vector<std::string>& ids, bool withMetadata = true) {
+        return fetchChunks(buildChunks(ids), true, withMetadata);
+    }
+
+    // Sends every request of the tick concurrently and parses them once all
+    // have arrived. Indexes of chunks whose games response failed or did
+    // not parse go to failedChunks.
+    std::unordered_map<std::string, GameSnapshot> fetchChunks(const std::vector<std::string>& chunks, bool withVotes,
+                                                              bool withMetadata,
+                                                              std::vector<size_t>* failedChunks = nullptr) {
+        std::vector<std::string> urls;
+        for (const auto& chunk : chunks) {
+            urls.push_back(baseUrl + "/v1/games?universeIds=" + chunk);
+            if (withVotes) urls.push_back(baseUrl + "/v1/games/votes?universeIds=" + chunk);
+        }
+        std::vector<std::string> responses = httpTransport().getMany(urls);
+
+        std::unordered_map<std::string, GameSnapshot> results;
+        int64_t timestampMs = nowEpochMs();
+        size_t stride = withVotes ? 2 : 1;
+        for (size_t i = 0; i < chunks.size(); i++) {
+            if (!parseGames(responses[i * stride], results, timestampMs, withMetadata) && failedChunks)
+                failedChunks->push_back(i);
+            if (withVotes) parseVotes(responses[i * stride + 1], results);
+        }
+        return results;
+    }
+
+private:
+    std::string baseUrl;
+
+    static GameSnapshot& slot(std::unordered_map<std::string, GameSnapshot>& results,
+                              const std::string& id, int64_t timestampMs) {
+        auto it = results.find(id);
+        if (it == results.end()) {
+            GameSnapshot snapshot;
+            snapshot.data = GameData{timestampMs, 0, 0, 0};
+            it = results.emplace(id, snapshot).first;
+        }
+        return it->second;
+    }
+
+    // Votes only go with a games entry of the same tick; on their own they
+    // would make a snapshot with CCU 0 out of a failed games request
+    static GameSnapshot* votesSlot(std::unordered_map<std::string, GameSnapshot>& results, const std::string& id) {
+        auto it = results.find(id);
+        return it != results.end() ? &it->second : nullptr;
+    }
+
+    static bool parseGames(const std::string& response, std::unordered_map<std::string, GameSnapshot>& results,
+                           int64_t timestampMs, bool withMetadata) {
+        unsigned fields = kFieldPlaying | kFieldVisits | kFieldFavorites;
+        if (withMetadata) fields |= kFieldMetadata | kFieldMaxPlayers;
+        return UniverseExtractor::extract(response, fields, [&](const ExtractedEntry& entry) {
+            GameSnapshot& snapshot = slot(results, std::to_string(entry.id), timestampMs);
+            // No playing count (missing or null): the entry is no CCU sample,
+            // but its metadata is still good for validation
+            snapshot.failed = !(entry.present & kFieldPlaying);
+            snapshot.data.ccu = (uint32_t)entry.playing;
+            snapshot.visits = entry.visits;
+            snapshot.favoritedCount = entry.favoritedCount;
+            if (!withMetadata) return;
+
+            GameInfo& info = snapshot.info;
+            info.name = orNA(entry.name);
+            info.description = orNA(entry.description);
+            info.created = orNA(entry.created);
+            info.creatorName = orNA(entry.creatorName);
+            info.creatorType = orNA(entry.creatorType);
+            info.maxPlayers = (int)entry.maxPlayers;
+            snapshot.hasInfo = true;
+        });
+    }
+
+    // Marks the snapshots whose votes arrived; a failed votes request
+    // (empty or unparsable response) marks none of its chunk
+    static void parseVotes(const std::string& response, std::unordered_map<std::string, GameSnapshot>& results) {
+        UniverseExtractor::extract(response, kFieldVotes, [&](const ExtractedEntry& entry) {
+            GameSnapshot* snapshot = votesSlot(results, std::to_string(entry.id));
+            if (!snapshot || !(entry.present & kFieldVotes)) return;
+            snapshot->data.upVotes = (uint32_t)entry.upVotes;
+            snapshot->data.downVotes = (uint32_t)entry.downVotes;
+            snapshot->hasVotes = true;
+        });
+    }
+
+    static std::string orNA(const std::string& value) {
+        return value.empty() ? "N/A" : value;
+    }
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// FNV-1a, used to detect torn or damaged records in the data files. Pass
+// the previous result as hash to checksum data in pieces.
+inline uint32_t fnv1a(const void* data, size_t size, uint32_t hash = 2166136261u) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <iostream>
+#include <cstdlib>
+#ifdef _WIN32
+#include <windows.h>
+#else
+typedef unsigned short WORD;
+#endif
+
+// Color helpers. Takes Windows console attributes; on other platforms the
+// few colors used by the monitor are mapped to ANSI escapes.
+inline void setColor(WORD color) {
+#ifdef _WIN32
+    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+    SetConsoleTextAttribute(hConsole, color);
+#else
+    const char* code = "0";
+    switch (color) {
+        case 9:  code = "94"; break; // Blue
+        case 10: code = "92"; break; // Green
+        case 11: code = "96"; break; // Cyan
+        case 12: code = "91"; break; // Red
+        case 13: code = "95"; break; // Magenta
+        case 14: code = "93"; break; // Yellow
+        default: break;
+    }
+    std::cout << "\033[" << code << "m";
+#endif
+}
+
+inline void resetColor() {
+    setColor(7); // Default gray
+}
+
+inline void initConsole() {
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+}
+
+// Keeps the console window open on Windows; no-op elsewhere
+inline void pauseConsole() {
+#ifdef _WIN32
+    system("pause");
+#endif
+}
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "series_join.hpp"
+
+// How two games move together, from the CCU changes between grid points
+// (deltas) rather than the CCU itself: levels of almost any two games
+// correlate through the time of day, changes only do when something moves
+// both of them.
+struct PairCorrelation {
+    static constexpr uint32_t kMinPoints = 30; // fewer common deltas are not scored
+    // A lag is only reported as a lead when it correlates this much more
+    // strongly than the same instant
+    static constexpr double kLeadMargin = 0.1;
+
+    float correlation = std::numeric_limits<float>::quiet_NaN(); // Pearson, same grid point
+    float lagged = std::numeric_limits<float>::quiet_NaN();      // strongest (by magnitude) over the lags
+    int32_t lagSteps = 0; // of lagged; > 0: the first game moves first, the second follows this many steps later
+    uint32_t points = 0;  // deltas both games have at lag 0
+
+    bool scored() const { return !std::isnan(correlation); }
+    bool hasLead() const {
+        return scored() && lagSteps != 0 && std::fabs(lagged) >= std::fabs(correlation) + kLeadMargin;
+    }
+};
+
+// Correlations of every pair of games, stored once per unordered pair
+class CorrelationMatrix {
+public:
+    explicit CorrelationMatrix(size_t games = 0) : games(games), pairs(games > 1 ? games * (games - 1) / 2 : 0) {}
+
+    size_t size() const { return games; }
+    size_t pairCount() const { return pairs.size(); }
+
+    // a != b; seen from a, so the lag is negated for a > b
+    PairCorrelation at(size_t a, size_t b) const {
+        if (a < b) return pairs[index(a, b)];
+        PairCorrelation pair = pairs[index(b, a)];
+        pair.lagSteps = -pair.lagSteps;
+        return pair;
+    }
+    PairCorrelation& upper(size_t a, size_t b) { return pairs[index(a, b)]; } // a < b
+
+private:
+    size_t games;
+    std::vector<PairCorrelation> pairs; // row by row, b > a
+
+    size_t index(size_t a, size_t b) const { return a * games - a * (a + 1) / 2 + (b - a - 1); }
+};
+
+namespace correlation_detail {
+
+// Sums are kept in kLanes independent float lanes, so the loops below
+// compile to packed SIMD multiply-adds without -ffast-math, and folded
+// into doubles every kChunk elements to keep float rounding small
+constexpr size_t kLanes = 8;
+constexpr size_t kChunk = 4096;
+
+inline double dot(const float* a, const float* b, size_t count) {
+    double total = 0.0;
+    for (size_t start = 0; start < count; start += kChunk) {
+        size_t end = std::min(count, start + kChunk);
+        float lanes[kLanes] = {};
+        size_t i = start;
+        for (; i + kLanes <= end; i += kLanes)
+            for (size_t l = 0; l < kLanes; l++) lanes[l] += a[i + l] * b[i + l];
+        for (; i < end; i++) lanes[0] += a[i] * b[i];
+        for (size_t l = 0; l < kLanes; l++) total += lanes[l];
+    }
+    return total;
+}
+
+// Sums for Pearson over the points where both series have a value
+struct Sums {
+    double n = 0, x = 0, y = 0, xx = 0, yy = 0, xy = 0;
+
+    float pearson() const {
+        if (n < PairCorrelation::kMinPoints) return std::numeric_limits<float>::quiet_NaN();
+        double varianceX = xx - x * x / n;
+        double varianceY = yy - y * y / n;
+        // Values are standardized, so the variance of a moving series is around n
+        if (varianceX <= 1e-6 * n || varianceY <= 1e-6 * n) return std::numeric_limits<float>::quiet_NaN();
+        double r = (xy - x * y / n) / std::sqrt(varianceX * varianceY);
+        return (float)std::max(-1.0, std::min(1.0, r));
+    }
+};
+
+// One game's deltas, standardized over its own points (z-scores, 0 at
+// gaps), with prefix sums of z and z^2 and the gaps as runs of points
+struct Deltas {
+    std::vector<float> z;
+    std::vector<double> sums, squares;            // over points [0, k)
+    std::vector<std::pair<size_t, size_t>> gaps; // [first, end), in order
+
+    void build(const std::vector<float>& ccu) {
+        size_t count = ccu.size() > 1 ? ccu.size() - 1 : 0;
+        auto isGap = [&](size_t i) { return AlignedTable::isGap(ccu[i]) || AlignedTable::isGap(ccu[i + 1]); };
+        double mean = 0.0, m2 = 0.0;
+        size_t points = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (isGap(i)) continue;
+            double delta = (double)ccu[i + 1] - ccu[i];
+            points++;
+            double diff = delta - mean;
+            mean += diff / points;
+            m2 += diff * (delta - mean);
+        }
+        double deviation = points > 1 ? std::sqrt(m2 / points) : 0.0;
+
+        z.assign(count, 0.0f);
+        sums.assign(count + 1, 0.0);
+        squares.assign(count + 1, 0.0);
+        gaps.clear();
+        for (size_t i = 0; i < count; i++) {
+            if (isGap(i)) {
+                if (!gaps.empty() && gaps.back().second == i) gaps.back().second++;
+                else gaps.push_back({i, i + 1});
+            } else if (deviation > 0) {
+                z[i] = (float)(((double)ccu[i + 1] - ccu[i] - mean) / deviation);
+            }
+            sums[i + 1] = sums[i] + z[i];
+            squares[i + 1] = squares[i] + (double)z[i] * z[i];
+        }
+    }
+};
+
+// a at point i against b at point i + lag, lag >= 0, over their overlap
+// and without the points where either has a gap.
+//
+// Gaps are 0 in z, so they add nothing to the cross term, and the other
+// sums come from the prefix sums minus what lies under the other game's
+// gaps. Besides the inner product this is O(gap runs), and gaps mostly
+// come in long runs (the monitor not running), common to all games.
+inline Sums lagSums(const Deltas& a, const Deltas& b, size_t lag) {
+    size_t count = a.z.size() - lag; // points [0, count) of a, [lag, lag + count) of b
+    Sums sums;
+    sums.n = (double)count;
+    sums.x = a.sums[count];
+    sums.xx = a.squares[count];
+    sums.y = b.sums[lag + count] - b.sums[lag];
+    sums.yy = b.squares[lag + count] - b.squares[lag];
+    sums.xy = dot(a.z.data(), b.z.data() + lag, count);
+
+    // A gap of either game drops the point (once, if both have one there)
+    auto clipA = [&](size_t i, size_t& first, size_t& end) {
+        first = a.gaps[i].first;
+        end = std::min(a.gaps[i].second, count);
+        return first < end;
+    };
+    auto clipB = [&](size_t i, size_t& first, size_t& end) {
+        if (b.gaps[i].second <= lag) return false;
+        first = std::max(b.gaps[i].first, lag) - lag;
+        end = std::min(b.gaps[i].second, lag + count) - lag;
+        return first < end;
+    };
+    size_t first, end;
+    for (size_t i = 0; i < a.gaps.size() && a.gaps[i].first < count; i++) {
+        if (!clipA(i, first, end)) continue;
+        sums.n -= (double)(end - first);
+        sums.y -= b.sums[lag + end] - b.sums[lag + first];
+        sums.yy -= b.squares[lag + end] - b.squares[lag + first];
+    }
+    for (size_t i = 0; i < b.gaps.size(); i++) {
+        if (!clipB(i, first, end)) continue;
+        sums.n -= (double)(end - first);
+        sums.x -= a.sums[end] - a.sums[first];
+        sums.xx -= a.squares[end] - a.squares[first];
+    }
+    // Points in gaps of both were taken off twice
+    size_t i = 0, j = 0;
+    size_t firstA, endA, firstB, endB;
+    while (i < a.gaps.size() && j < b.gaps.size()) {
+        if (!clipA(i, firstA, endA)) { i++; continue; }
+        if (!clipB(j, firstB, endB)) { j++; continue; }
+        size_t from = std::max(firstA, firstB), to = std::min(endA, endB);
+        if (from < to) sums.n += (double)(to - from);
+        if (endA < endB) i++;
+        else j++;
+    }
+    return sums;
+}
+
+} // namespace correlation_detail
+
+// Pearson correlation of the CCU deltas of every pair of aligned games at
+// the same grid point, and at every lag up to maxLagSteps grid points
+// either way, keeping the strongest lag.
+//
+// Each game's deltas are standardized once; a pair and lag then costs one
+// SIMD inner product over the overlap plus a correction per gap run (gaps
+// are left out of the pair instead of being filled). Rows of
+// the matrix are handed out to threads workers (hardware threads when 0)
+// one at a time, longest rows first, so the work stays balanced.
+inline CorrelationMatrix correlateDeltas(const AlignedTable& table, size_t maxLagSteps, unsigned threads = 0) {
+    using namespace correlation_detail;
+    size_t games = table.columns.size();
+    CorrelationMatrix matrix(games);
+    size_t count = table.grid.size > 1 ? table.grid.size - 1 : 0;
+    if (games < 2 || count == 0) return matrix;
+    size_t maxLag = std::min(maxLagSteps, count - 1);
+
+    std::vector<Deltas> deltas(games);
+    for (size_t g = 0; g < games; g++) deltas[g].build(table.columns[g]);
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t a = next++; a + 1 < games; a = next++) {
+            for (size_t b = a + 1; b < games; b++) {
+                PairCorrelation& pair = matrix.upper(a, b);
+                Sums same = lagSums(deltas[a], deltas[b], 0);
+                pair.points = (uint32_t)same.n;
+                pair.correlation = same.pearson();
+                if (!pair.scored()) continue;
+                pair.lagged = pair.correlation;
+                for (size_t lag = 1; lag <= maxLag; lag++) {
+                    float ahead = lagSums(deltas[a], deltas[b], lag).pearson(); // a first
+                    float behind = lagSums(deltas[b], deltas[a], lag).pearson(); // b first
+                    if (std::fabs(ahead) > std::fabs(pair.lagged)) {
+                        pair.lagged = ahead;
+                        pair.lagSteps = (int32_t)lag;
+                    }
+                    if (std::fabs(behind) > std::fabs(pair.lagged)) {
+                        pair.lagged = behind;
+                        pair.lagSteps = -(int32_t)lag;
+                    }
+                }
+            }
+        }
+    };
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t workerCount = std::min<size_t>(threads, games - 1);
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < workerCount; i++) workers.emplace_back(worker);
+    worker(); // this thread is one of them
+    for (auto& t : workers) t.join();
+    return matrix;
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "game_data.hpp"
+
+// Online detection of CCU drops for one game, O(1) time and memory per
+// sample.
+//
+// The baseline is an exponentially weighted moving average (EWMA) of CCU
+// with a slower EWMA variance next to it. Each sample is compared with the
+// baseline before it is folded in, in two ways:
+//   - z-score: a sample more than kZThreshold deviations below the
+//     baseline is a sudden drop
+//   - lower CUSUM: deviations below the baseline beyond a slack of
+//     kCusumSlack are summed, so a slide too slow for the z-score is
+//     flagged once the sum passes kCusumThreshold
+// A drop is dated back to the last sample before the CUSUM started to
+// rise, and the baseline is reset to what it was then. While the drop
+// lasts the baseline is frozen. The drop ends when CCU has been back
+// within one deviation of it for kRecoverSamples samples in a row, or
+// when it has made no new low for kSettleSamples samples; the new level
+// then becomes the baseline. A long slide (an evening decline) is
+// therefore reported as one drop, from its start to where it bottoms out.
+class DropDetector {
+public:
+    static constexpr double kAlpha = 0.1;          // EWMA weight of a new sample
+    static constexpr double kVarianceAlpha = 0.05; // same for the variance
+    static constexpr double kZThreshold = 4.0;
+    static constexpr double kCusumSlack = 0.5;     // in deviations
+    static constexpr double kCusumThreshold = 5.0; // in deviations
+    static constexpr uint32_t kWarmupSamples = 10; // baseline only, no drops
+    static constexpr uint32_t kRecoverSamples = 3;
+    static constexpr uint32_t kSettleSamples = 15;
+    // Lower bound of the deviation relative to the baseline: the CCU of a
+    // steady game barely moves, and a few players leaving is not a drop
+    static constexpr double kMinRelativeDeviation = 0.01;
+
+    enum Event { kNone, kDropStarted, kDropEnded };
+
+    struct Drop {
+        int64_t startMs = 0;    // last sample before the drop
+        uint32_t startCcu = 0;
+        double baseline = 0.0;  // expected CCU when it started
+        int64_t lowMs = 0;
+        uint32_t lowCcu = 0;
+        int64_t lastMs = 0;     // latest sample of the drop
+        uint32_t lastCcu = 0;
+        uint32_t samples = 0;   // samples since it started
+        uint32_t sinceLow = 0;  // samples since the low point
+        uint32_t recovering = 0; // samples in a row back near the baseline
+        bool recovered = false; // ended by CCU coming back, not by settling
+
+        double magnitude() const { return (double)startCcu - lowCcu; }
+        double percent() const { return startCcu > 0 ? magnitude() / startCcu * 100.0 : 0.0; }
+        // CCU per minute from the start to the low point (negative)
+        double slopePerMinute() const {
+            double minutes = (lowMs - startMs) / 60000.0;
+            return minutes > 0 ? -magnitude() / minutes : 0.0;
+        }
+        double durationMinutes() const { return (lastMs - startMs) / 60000.0; }
+    };
+
+    Event add(const GameData& sample) {
+        double value = sample.ccu;
+        if (samples == 0) {
+            mean = value;
+            variance = 0.0;
+            samples = 1;
+            previous = sample;
+            return kNone;
+        }
+        double z = (value - mean) / deviation();
+
+        if (active) {
+            current.lastMs = sample.timestampMs;
+            current.lastCcu = sample.ccu;
+            current.samples++;
+            current.sinceLow++;
+            if (sample.ccu < current.lowCcu) {
+                current.lowCcu = sample.ccu;
+                current.lowMs = sample.timestampMs;
+                current.sinceLow = 0;
+            }
+            previous = sample;
+            current.recovering = z > -1.0 ? current.recovering + 1 : 0;
+            if (current.recovering >= kRecoverSamples) {
+                current.recovered = true;
+            } else if (current.sinceLow >= kSettleSamples) {
+                current.recovered = false;
+                mean = value; // the new normal; the variance carries over
+            } else {
+                return kNone;
+            }
+            active = false;
+            cusum = 0.0;
+            if (current.magnitude() > largest.magnitude()) largest = current;
+            return kDropEnded;
+        }
+
+        // Where a drop would have started if this sample begins one
+        if (cusum == 0.0) {
+            candidate = previous;
+            candidateMean = mean;
+            candidateVariance = variance;
+        }
+        cusum = std::max(0.0, cusum - z - kCusumSlack);
+        previous = sample;
+
+        if (samples >= kWarmupSamples && (z < -kZThreshold || cusum > kCusumThreshold)) {
+            mean = candidateMean;
+            variance = candidateVariance;
+            current = Drop{};
+            current.startMs = candidate.timestampMs;
+            current.startCcu = candidate.ccu;
+            current.baseline = mean;
+            current.lowMs = current.lastMs = sample.timestampMs;
+            current.lowCcu = current.lastCcu = std::min(sample.ccu, candidate.ccu);
+            current.samples = 1;
+            active = true;
+            dropCount++;
+            return kDropStarted;
+        }
+
+        double diff = value - mean;
+        mean += kAlpha * diff;
+        variance = (1.0 - kVarianceAlpha) * (variance + kVarianceAlpha * diff * diff);
+        if (samples < kWarmupSamples) samples++;
+        return kNone;
+    }
+
+    // Guard for callers holding a snapshot: a failed fetch is no sample,
+    // and its placeholder CCU of 0 would look like a drop of 100%. The
+    // monitor never passes failed snapshots here (it counts them as missed
+    // ticks first), so this only keeps a future caller from doing so.
+    Event add(const GameSnapshot& snapshot) {
+        return snapshot.failed ? kNone : add(snapshot.data);
+    }
+
+    bool inDrop() const { return active; }
+    // The ongoing drop, or the last one once it ended
+    const Drop& drop() const { return current; }
+    uint32_t getDropCount() const { return dropCount; }
+    // Biggest drop by magnitude, including the ongoing one; nullptr if none
+    const Drop* largestDrop() const {
+        if (active && current.magnitude() > largest.magnitude()) return &current;
+        return dropCount > 0 ? &largest : nullptr;
+    }
+    double getBaseline() const { return mean; }
+
+private:
+    double mean = 0.0;
+    double variance = 0.0;
+    double cusum = 0.0;
+    uint32_t samples = 0; // counts up to kWarmupSamples
+    uint32_t dropCount = 0;
+    bool active = false;
+    GameData previous{};
+    GameData candidate{};
+    double candidateMean = 0.0, candidateVariance = 0.0;
+    Drop current;
+    Drop largest;
+
+    double deviation() const {
+        return std::max(std::sqrt(variance), std::max(1.0, kMinRelativeDeviation * mean));
+    }
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+
+// One sample. Kept small and flat; text is only produced when rendering.
+struct GameData {
+    int64_t timestampMs; // Unix epoch milliseconds
+    uint32_t ccu;
+    uint32_t upVotes;
+    uint32_t downVotes;
+
+    // Like ratio in percent, derived from the vote counts
+    double rating() const {
+        uint64_t totalVotes = (uint64_t)upVotes + downVotes;
+        return totalVotes > 0 ? (double(upVotes) / totalVotes) * 100.0 : 0.0;
+    }
+
+    // Samples whose votes request failed are stored with 0/0 votes, so a
+    // sample without any votes has no rating rather than a 0% one
+    bool hasVotes() const { return upVotes > 0 || downVotes > 0; }
+};
+
+struct GameInfo {
+    std::string name;
+    std::string description;
+    std::string created;
+    std::string creatorName;
+    std::string creatorType;
+    int maxPlayers = 0;
+};
+
+// Everything one tick learns about a universe from the games and votes
+// responses: the sample itself plus the counters and metadata parsed from
+// the same bytes. A failed snapshot (no games entry for the universe:
+// request failed, timed out or did not parse; or an entry without a
+// playing count) carries no CCU; its zeros must not be recorded as a
+// sample.
+// Without hasVotes the votes entry was missing (its request failed): the
+// sample's CCU is real, its 0/0 votes are not.
+struct GameSnapshot {
+    GameData data;
+    long long visits = 0;
+    long long favoritedCount = 0;
+    GameInfo info;
+    bool hasInfo = false;
+    bool hasVotes = false;
+    bool failed = false;
+
+    static GameSnapshot failedAt(int64_t timestampMs) {
+        GameSnapshot snapshot;
+        snapshot.data = GameData{timestampMs, 0, 0, 0};
+        snapshot.failed = true;
+        return snapshot;
+    }
+};
+
+inline int64_t nowEpochMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Local time as "YYYY-MM-DD HH:MM:SS"
+inline std::string formatTimestamp(int64_t epochMs) {
+    std::time_t time_t = (std::time_t)(epochMs / 1000);
+    auto tm = *std::localtime(&time_t);
+
+    std::stringstream ss;
+    ss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
+    return ss.str();
+}
+
+// Calendar date in UTC, for day buckets (which start at 00:00 UTC)
+inline std::string formatUtcDate(int64_t epochMs) {
+    std::time_t time_t = (std::time_t)(epochMs / 1000);
+    auto tm = *std::gmtime(&time_t);
+
+    std::stringstream ss;
+    ss << std::put_time(&tm, "%Y-%m-%d");
+    return ss.str();
+}
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include "game_data.hpp"
+#include "mapped_file.hpp"
+
+// On-disk cache of game metadata keyed by universe ID.
+// Name, creator and created date almost never change, so validated info is
+// kept for kValidTtlMs and IDs the API returned nothing for are remembered
+// (negative entries) for kInvalidTtlMs. The file is memory mapped and
+// looked up by binary search over a sorted fixed-size index, so a restart
+// of a large watchlist reads only the entries it needs.
+//
+// File layout (host byte order):
+//   Header                  magic "RMGC", version, entry count
+//   Entry[count]            sorted by universe ID
+//   string blob             per valid entry: name, description, created,
+//                           creator name, creator type as u32 length + bytes
+//
+// New entries are collected in memory and written by save(), which merges
+// them with the unexpired mapped entries into a temp file and renames it
+// over the old one, so readers never see a half written cache. A file cut
+// short anyway (the renamed data never reached the disk) keeps the entries
+// that are complete and drops the rest on the next save; a cut index
+// counts as an empty cache.
+class GameInfoCache {
+public:
+    static constexpr int64_t kValidTtlMs = 7LL * 24 * 60 * 60 * 1000;
+    static constexpr int64_t kInvalidTtlMs = 24LL * 60 * 60 * 1000;
+
+    enum Lookup { kMiss, kValid, kInvalid };
+
+    // ROBLOX_MONITOR_CACHE overrides the file location
+    static std::string defaultPath() {
+        const char* env = std::getenv("ROBLOX_MONITOR_CACHE");
+        return (env && *env) ? env : "game_info_cache.bin";
+    }
+
+    explicit GameInfoCache(std::string path = defaultPath()) : path(std::move(path)) { load(); }
+
+    Lookup lookup(const std::string& universeId, GameInfo& info, int64_t nowMs = nowEpochMs()) const {
+        uint64_t id = parseId(universeId);
+        auto pendingIt = pending.find(id);
+        if (pendingIt != pending.end()) {
+            if (pendingIt->second.expiresMs <= nowMs) return kMiss;
+            if (!pendingIt->second.valid) return kInvalid;
+            info = pendingIt->second.info;
+            return kValid;
+        }
+
+        const Entry* begin = entries();
+        const Entry* end = begin + count;
+        const Entry* it = std::lower_bound(begin, end, id,
+                                           [](const Entry& e, uint64_t key) { return e.universeId < key; });
+        if (it == end || it->universeId != id || it->expiresMs <= nowMs) return kMiss;
+        if (!(it->flags & kFlagValid)) return kInvalid;
+        return decode(*it, info) ? kValid : kMiss;
+    }
+
+    void put(const std::string& universeId, const GameInfo& info, int64_t nowMs = nowEpochMs()) {
+        pending[parseId(universeId)] = Pending{nowMs + kValidTtlMs, true, info};
+    }
+
+    void putInvalid(const std::string& universeId, int64_t nowMs = nowEpochMs()) {
+        pending[parseId(universeId)] = Pending{nowMs + kInvalidTtlMs, false, GameInfo()};
+    }
+
+    bool hasChanges() const { return !pending.empty(); }
+
+    // Writes mapped and pending entries (expired ones dropped) to a temp
+    // file, replaces the cache file with it and maps the new file.
+    bool save(int64_t nowMs = nowEpochMs()) {
+        if (pending.empty()) return true;
+
+        std::vector<Entry> index;
+        std::string blob;
+        const Entry* mapped = entries();
+        size_t m = 0;
+        auto pendingIt = pending.begin();
+        while (m < count || pendingIt != pending.end()) {
+            bool takePending = m == count ||
+                (pendingIt != pending.end() && pendingIt->first <= mapped[m].universeId);
+            if (takePending) {
+                if (m < count && mapped[m].universeId == pendingIt->first) m++; // replaced
+                const Pending& entry = pendingIt->second;
+                if (entry.expiresMs > nowMs) {
+                    Entry e{pendingIt->first, entry.expiresMs, 0, 0, entry.info.maxPlayers,
+                            entry.valid ? kFlagValid : 0u};
+                    if (entry.valid) {
+                        e.blobOffset = (uint32_t)blob.size();
+                        encode(entry.info, blob);
+                        e.blobLength = (uint32_t)(blob.size() - e.blobOffset);
+                    }
+                    index.push_back(e);
+                }
+                ++pendingIt;
+            } else {
+                Entry e = mapped[m++];
+                if (e.expiresMs <= nowMs) continue;
+                // A torn file (cut off in the blob) loses the entries whose
+                // strings are not all there; the ones before them are kept
+                if ((e.flags & kFlagValid) && (uint64_t)e.blobOffset + e.blobLength > blobSize()) continue;
+                if (e.flags & kFlagValid) {
+                    const char* bytes = blobStart() + e.blobOffset;
+                    e.blobOffset = (uint32_t)blob.size();
+                    blob.append(bytes, e.blobLength);
+                }
+                index.push_back(e);
+            }
+        }
+
+        Header header{};
+        std::memcpy(header.magic, kMagic, sizeof(header.magic));
+        header.version = kVersion;
+        header.count = (uint32_t)index.size();
+
+        std::string tempPath = path + ".tmp";
+        {
+            std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+            if (!out) return false;
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            if (!index.empty())
+                out.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(Entry));
+            out.write(blob.data(), blob.size());
+            if (!out.flush()) {
+                out.close();
+                std::remove(tempPath.c_str());
+                return false;
+            }
+        }
+
+        // Windows cannot replace a file that is still mapped
+        file.unmap();
+        count = 0;
+#ifdef _WIN32
+        bool replaced = MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        bool replaced = std::rename(tempPath.c_str(), path.c_str()) == 0;
+#endif
+        if (!replaced) std::remove(tempPath.c_str());
+        load();
+        if (replaced) pending.clear();
+        return replaced;
+    }
+
+    // Entries in the mapped file, including expired ones
+    size_t size() const { return count; }
+
+private:
+    static constexpr char kMagic[4] = {'R', 'M', 'G', 'C'};
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint32_t kFlagValid = 1;
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t count;
+        uint32_t reserved;
+    };
+
+    struct Entry {
+        uint64_t universeId;
+        int64_t expiresMs;
+        uint32_t blobOffset;
+        uint32_t blobLength;
+        int32_t maxPlayers;
+        uint32_t flags;
+    };
+    static_assert(sizeof(Header) == 16 && sizeof(Entry) == 32, "cache layout must not have padding");
+
+    struct Pending {
+        int64_t expiresMs;
+        bool valid;
+        GameInfo info;
+    };
+
+    std::string path;
+    MappedFile file;
+    size_t count = 0; // 0 if the file is missing or unreadable
+    std::map<uint64_t, Pending> pending;
+
+    static uint64_t parseId(const std::string& universeId) {
+        return std::strtoull(universeId.c_str(), nullptr, 10);
+    }
+
+    const Entry* entries() const {
+        return count ? reinterpret_cast<const Entry*>(file.data() + sizeof(Header)) : nullptr;
+    }
+
+    const char* blobStart() const {
+        return file.data() + sizeof(Header) + count * sizeof(Entry);
+    }
+
+    size_t blobSize() const {
+        return file.size() - sizeof(Header) - count * sizeof(Entry);
+    }
+
+    // Maps the file and checks the header; a corrupt file counts as empty
+    void load() {
+        count = 0;
+        if (!file.map(path)) return;
+        Header header;
+        if (file.size() < sizeof(Header)) return;
+        std::memcpy(&header, file.data(), sizeof(Header));
+        if (std::memcmp(header.magic, kMagic, sizeof(header.magic)) != 0 || header.version != kVersion) return;
+        if ((file.size() - sizeof(Header)) / sizeof(Entry) < header.count) return;
+        count = header.count;
+    }
+
+    static void encode(const GameInfo& info, std::string& blob) {
+        for (const std::string* field : {&info.name, &info.description, &info.created,
+                                         &info.creatorName, &info.creatorType}) {
+            uint32_t length = (uint32_t)field->size();
+            blob.append(reinterpret_cast<const char*>(&length), sizeof(length));
+            blob.append(*field);
+        }
+    }
+
+    bool decode(const Entry& entry, GameInfo& info) const {
+        if ((uint64_t)entry.blobOffset + entry.blobLength > blobSize()) return false;
+        const char* pos = blobStart() + entry.blobOffset;
+        const char* end = pos + entry.blobLength;
+        for (std::string* field : {&info.name, &info.description, &info.created,
+                                   &info.creatorName, &info.creatorType}) {
+            uint32_t length;
+            if (end - pos < (ptrdiff_t)sizeof(length)) return false;
+            std::memcpy(&length, pos, sizeof(length));
+            pos += sizeof(length);
+            if ((size_t)(end - pos) < length) return false;
+            field->assign(pos, length);
+            pos += length;
+        }
+        info.maxPlayers = entry.maxPlayers;
+        return true;
+    }
+};
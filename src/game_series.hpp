@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "game_data.hpp"
+
+// Per-game time series stored as a structure of arrays: one contiguous
+// column per field, so scans over a single field (e.g. CCU) touch only
+// that field's memory. About 20 bytes per sample and no per-sample heap
+// blocks.
+//
+// With a capacity the series is a ring buffer: once full, each new sample
+// overwrites the oldest one, so memory stays flat however long the monitor
+// runs. Indexing is always oldest-retained first.
+class GameSeries {
+private:
+    std::vector<int64_t> timestampsMs;
+    std::vector<uint32_t> ccus;
+    std::vector<uint32_t> upVotes;
+    std::vector<uint32_t> downVotes;
+    size_t capacity;        // 0 = unbounded
+    size_t head = 0;        // slot of the oldest sample once the ring is full
+    uint64_t totalPushed = 0;
+
+    size_t slot(size_t i) const {
+        size_t s = head + i;
+        return s < ccus.size() ? s : s - ccus.size();
+    }
+
+public:
+    explicit GameSeries(size_t capacity = 0) : capacity(capacity) {}
+
+    void push_back(const GameData& data) {
+        totalPushed++;
+        if (capacity == 0 || ccus.size() < capacity) {
+            timestampsMs.push_back(data.timestampMs);
+            ccus.push_back(data.ccu);
+            upVotes.push_back(data.upVotes);
+            downVotes.push_back(data.downVotes);
+            return;
+        }
+        timestampsMs[head] = data.timestampMs;
+        ccus[head] = data.ccu;
+        upVotes[head] = data.upVotes;
+        downVotes[head] = data.downVotes;
+        head = (head + 1 == capacity) ? 0 : head + 1;
+    }
+
+    // Counts samples that were taken but are not retained here (e.g. when
+    // a series is rebuilt from disk with only its newest samples)
+    void skip(uint64_t count) { totalPushed += count; }
+
+    // Samples currently retained
+    size_t size() const { return ccus.size(); }
+    bool empty() const { return ccus.empty(); }
+    size_t getCapacity() const { return capacity; }
+
+    // Samples ever pushed, including the ones already overwritten
+    uint64_t totalCount() const { return totalPushed; }
+    // Session-wide index of operator[](0)
+    uint64_t firstRetainedIndex() const { return totalPushed - ccus.size(); }
+
+    GameData operator[](size_t i) const {
+        size_t s = slot(i);
+        return GameData{timestampsMs[s], ccus[s], upVotes[s], downVotes[s]};
+    }
+    GameData front() const { return (*this)[0]; }
+    GameData back() const { return (*this)[size() - 1]; }
+};
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "game_data.hpp"
+
+// Gorilla-style block codec for GameData series.
+// The first sample of a block is stored raw. After that:
+//   timestamp   delta-of-delta, zig-zag encoded, in a prefix-coded bucket:
+//               '0' = same interval, '10' + 7 bits, '110' + 12 bits,
+//               '1110' + 20 bits, '1111' + 64 bits
+//   ccu, votes  delta from the previous sample: '0' if unchanged, else
+//               '1' + zig-zag varint (7 data bits + continuation bit per group)
+// Minute samples usually cost one bit of timestamp, so a sample that
+// takes 24 bytes raw compresses to a few bytes. Rating is not stored; it
+// is derived from the (exact) vote counts.
+
+class BitWriter {
+public:
+    void write(uint64_t value, unsigned bits) {
+        while (bits > 0) {
+            if (used == 0) bytes.push_back(0);
+            unsigned room = 8 - used;
+            unsigned take = bits < room ? bits : room;
+            uint8_t chunk = (uint8_t)((value >> (bits - take)) & ((1u << take) - 1));
+            bytes.back() |= (uint8_t)(chunk << (room - take));
+            used = (used + take) & 7;
+            bits -= take;
+        }
+    }
+
+    void writeBit(bool bit) { write(bit ? 1 : 0, 1); }
+
+    const std::vector<uint8_t>& data() const { return bytes; }
+    void clear() { bytes.clear(); used = 0; }
+
+private:
+    std::vector<uint8_t> bytes;
+    unsigned used = 0; // bits used in the last byte
+};
+
+// Reads through a 64-bit window refilled a byte at a time, so most reads
+// are a shift and a mask
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+    uint64_t read(unsigned bits) {
+        if (bits > 56) {
+            uint64_t high = read(bits - 32);
+            return (high << 32) | read(32);
+        }
+        if (available < bits) refill();
+        if (available < bits) { overrun = true; return 0; }
+        uint64_t value = window >> (64 - bits);
+        window <<= bits;
+        available -= bits;
+        return value;
+    }
+
+    bool readBit() { return read(1) != 0; }
+    bool failed() const { return overrun; }
+
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t next = 0;        // next byte to load into the window
+    uint64_t window = 0;    // unread bits, most significant first
+    unsigned available = 0; // valid bits in window
+    bool overrun = false;
+
+    void refill() {
+        while (available <= 56 && next < size) {
+            window |= (uint64_t)data[next++] << (56 - available);
+            available += 8;
+        }
+    }
+};
+
+inline uint64_t zigZag(int64_t value) { return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63); }
+inline int64_t unZigZag(uint64_t value) { return (int64_t)(value >> 1) ^ -(int64_t)(value & 1); }
+
+// Streaming encoder: add() samples one at a time, then take data() as one block
+class GorillaEncoder {
+public:
+    void add(const GameData& sample) {
+        if (count == 0) {
+            bits.write((uint64_t)sample.timestampMs, 64);
+            bits.write(sample.ccu, 32);
+            bits.write(sample.upVotes, 32);
+            bits.write(sample.downVotes, 32);
+        } else {
+            int64_t delta = sample.timestampMs - prev.timestampMs;
+            writeDeltaOfDelta(delta - prevDelta);
+            prevDelta = delta;
+            writeValueDelta((int64_t)sample.ccu - (int64_t)prev.ccu);
+            writeValueDelta((int64_t)sample.upVotes - (int64_t)prev.upVotes);
+            writeValueDelta((int64_t)sample.downVotes - (int64_t)prev.downVotes);
+        }
+        if (count == 0) first = sample;
+        prev = sample;
+        count++;
+    }
+
+    uint32_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const GameData& front() const { return first; }
+    const GameData& back() const { return prev; }
+    const std::vector<uint8_t>& data() const { return bits.data(); }
+
+    void clear() {
+        bits.clear();
+        count = 0;
+        prevDelta = 0;
+    }
+
+private:
+    BitWriter bits;
+    uint32_t count = 0;
+    GameData first{};
+    GameData prev{};
+    int64_t prevDelta = 0;
+
+    void writeDeltaOfDelta(int64_t dod) {
+        uint64_t value = zigZag(dod);
+        if (value == 0) { bits.write(0b0, 1); return; }
+        if (value < (1u << 7)) { bits.write(0b10, 2); bits.write(value, 7); return; }
+        if (value < (1u << 12)) { bits.write(0b110, 3); bits.write(value, 12); return; }
+        if (value < (1u << 20)) { bits.write(0b1110, 4); bits.write(value, 20); return; }
+        bits.write(0b1111, 4);
+        bits.write(value, 64);
+    }
+
+    void writeValueDelta(int64_t delta) {
+        uint64_t value = zigZag(delta);
+        if (value == 0) { bits.writeBit(false); return; }
+        bits.writeBit(true);
+        do {
+            uint64_t group = value & 0x7f;
+            value >>= 7;
+            bits.write(group | (value ? 0x80 : 0), 8);
+        } while (value);
+    }
+};
+
+// Decodes a block of count samples, appending them to out. Returns false
+// (keeping what was decoded) if the block is truncated.
+inline bool decodeGorillaBlock(const uint8_t* data, size_t size, uint32_t count, std::vector<GameData>& out) {
+    if (count == 0) return true;
+    BitReader bits(data, size);
+    GameData sample;
+    sample.timestampMs = (int64_t)bits.read(64);
+    sample.ccu = (uint32_t)bits.read(32);
+    sample.upVotes = (uint32_t)bits.read(32);
+    sample.downVotes = (uint32_t)bits.read(32);
+    if (bits.failed()) return false;
+    out.reserve(out.size() + count);
+    out.push_back(sample);
+
+    auto readDeltaOfDelta = [&bits]() -> int64_t {
+        if (!bits.readBit()) return 0;
+        if (!bits.readBit()) return unZigZag(bits.read(7));
+        if (!bits.readBit()) return unZigZag(bits.read(12));
+        if (!bits.readBit()) return unZigZag(bits.read(20));
+        return unZigZag(bits.read(64));
+    };
+    auto readValueDelta = [&bits]() -> int64_t {
+        if (!bits.readBit()) return 0;
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            uint64_t group = bits.read(8);
+            value |= (group & 0x7f) << shift;
+            if (!(group & 0x80) || bits.failed()) break;
+        }
+        return unZigZag(value);
+    };
+
+    int64_t delta = 0;
+    for (uint32_t i = 1; i < count; i++) {
+        delta += readDeltaOfDelta();
+        sample.timestampMs += delta;
+        sample.ccu = (uint32_t)((int64_t)sample.ccu + readValueDelta());
+        sample.upVotes = (uint32_t)((int64_t)sample.upVotes + readValueDelta());
+        sample.downVotes = (uint32_t)((int64_t)sample.downVotes + readValueDelta());
+        if (bits.failed()) return false;
+        out.push_back(sample);
+    }
+    return true;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <memory>
+#include "http_transport.hpp"
+#ifdef _WIN32
+#include "wininet_transport.hpp"
+#else
+#include "posix_transport.hpp"
+#endif
+
+// Process-wide transport shared by all monitors and threads. Defaults to the
+// platform backend; setHttpTransport swaps it (e.g. for a stand-in server).
+inline std::unique_ptr<HttpTransport>& httpTransportSlot() {
+#ifdef _WIN32
+    static std::unique_ptr<HttpTransport> transport(new WinInetTransport());
+#else
+    static std::unique_ptr<HttpTransport> transport(new PosixTransport());
+#endif
+    return transport;
+}
+
+inline HttpTransport& httpTransport() { return *httpTransportSlot(); }
+
+inline void setHttpTransport(std::unique_ptr<HttpTransport> transport) {
+    httpTransportSlot() = std::move(transport);
+}
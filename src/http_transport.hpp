@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Abstract HTTP GET transport used by the fetchers.
+// Backends return the response body, or an empty string on any failure
+// (connection error, timeout or non-2xx status) after logging it.
+class HttpTransport {
+public:
+    virtual ~HttpTransport() = default;
+
+    virtual std::string get(const std::string& url) = 0;
+
+    // Issues all requests concurrently and returns the bodies in the same
+    // order. The caller waits for the slowest request, not the sum.
+    virtual std::vector<std::string> getMany(const std::vector<std::string>& urls) = 0;
+};
+
+// Pieces of an http(s) URL
+struct ParsedUrl {
+    bool https = false;
+    std::string host;
+    int port = 0;
+    std::string path;
+
+    // "https://host:port/path?query" -> parts; returns false if malformed
+    static bool parse(const std::string& url, ParsedUrl& out) {
+        size_t schemeEnd = url.find("://");
+        if (schemeEnd == std::string::npos) return false;
+        std::string scheme = url.substr(0, schemeEnd);
+        if (scheme == "https") out.https = true;
+        else if (scheme == "http") out.https = false;
+        else return false;
+
+        size_t hostStart = schemeEnd + 3;
+        size_t pathStart = url.find('/', hostStart);
+        std::string authority = url.substr(hostStart, pathStart == std::string::npos ? std::string::npos : pathStart - hostStart);
+        out.path = pathStart == std::string::npos ? "/" : url.substr(pathStart);
+
+        size_t colon = authority.rfind(':');
+        if (colon != std::string::npos) {
+            out.host = authority.substr(0, colon);
+            try {
+                out.port = std::stoi(authority.substr(colon + 1));
+            } catch (...) {
+                return false;
+            }
+        } else {
+            out.host = authority;
+            out.port = out.https ? 443 : 80;
+        }
+        return !out.host.empty() && out.port > 0 && out.port < 65536;
+    }
+};
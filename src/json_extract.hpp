@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include "json.hpp"
+
+// Fields UniverseExtractor can pull out of each data[] entry
+enum ExtractField : unsigned {
+    kFieldPlaying    = 1u << 0,
+    kFieldVisits     = 1u << 1,
+    kFieldFavorites  = 1u << 2,
+    kFieldMaxPlayers = 1u << 3,
+    kFieldMetadata   = 1u << 4, // name, description, created, creator name/type
+    kFieldVotes      = 1u << 5, // upVotes, downVotes
+};
+
+// One data[] entry. Only the requested fields are filled; `present` has a
+// bit set for every field that was actually seen with a value (a null
+// leaves its bit clear), so callers can tell a missing count from 0.
+struct ExtractedEntry {
+    long long id = -1;
+    long long playing = 0;
+    long long visits = 0;
+    long long favoritedCount = 0;
+    long long maxPlayers = 0;
+    long long upVotes = 0;
+    long long downVotes = 0;
+    unsigned present = 0;
+    std::string name;
+    std::string description;
+    std::string created;
+    std::string creatorName;
+    std::string creatorType;
+};
+
+// Schema-driven SAX extractor for {"data":[{...},...]} responses from the
+// games endpoints. Walks the byte stream once and copies only the fields in
+// the schema; skipped values (long descriptions, nested objects) are never
+// stored, and no json DOM is built.
+class UniverseExtractor {
+public:
+    // Calls fn(const ExtractedEntry&) for every data[] entry that has an id.
+    // Returns false if the response is not valid JSON (entries seen before
+    // the error have already been delivered).
+    template <typename Fn>
+    static bool extract(const std::string& response, unsigned fields, Fn fn) {
+        if (response.empty()) return false;
+        Handler<Fn> handler(fields, fn);
+        try {
+            return nlohmann::json::sax_parse(response, &handler);
+        } catch (...) {
+            return false;
+        }
+    }
+
+private:
+    enum Slot { kNone, kId, kPlaying, kVisits, kFavorites, kMaxPlayers, kUpVotes, kDownVotes,
+                kName, kDescription, kCreated, kCreator, kCreatorName, kCreatorType };
+
+    template <typename Fn>
+    class Handler {
+    public:
+        using number_integer_t = nlohmann::json::number_integer_t;
+        using number_unsigned_t = nlohmann::json::number_unsigned_t;
+        using number_float_t = nlohmann::json::number_float_t;
+        using string_t = nlohmann::json::string_t;
+        using binary_t = nlohmann::json::binary_t;
+
+        Handler(unsigned fields, Fn& fn) : fields(fields), fn(fn) {}
+
+        bool null() { pending = kNone; return true; }
+        bool boolean(bool) { pending = kNone; return true; }
+        bool number_integer(number_integer_t val) { storeNumber((long long)val); return true; }
+        bool number_unsigned(number_unsigned_t val) { storeNumber((long long)val); return true; }
+        bool number_float(number_float_t val, const string_t&) { storeNumber((long long)val); return true; }
+        bool binary(binary_t&) { pending = kNone; return true; }
+
+        bool string(string_t& val) {
+            switch (pending) {
+                case kName: entry.name = val; break;
+                case kDescription: entry.description = val; break;
+                case kCreated: entry.created = val; break;
+                case kCreatorName: entry.creatorName = val; break;
+                case kCreatorType: entry.creatorType = val; break;
+                default: break;
+            }
+            if (pending >= kName) entry.present |= kFieldMetadata;
+            pending = kNone;
+            return true;
+        }
+
+        bool start_object(std::size_t) {
+            if (inData && depth == 2) {
+                // New data[] entry; strings keep their capacity between entries
+                entry.id = -1;
+                entry.present = 0;
+                entry.playing = entry.visits = entry.favoritedCount = entry.maxPlayers = 0;
+                entry.upVotes = entry.downVotes = 0;
+                entry.name.clear();
+                entry.description.clear();
+                entry.created.clear();
+                entry.creatorName.clear();
+                entry.creatorType.clear();
+            } else if (inData && depth == 3 && pending == kCreator) {
+                inCreator = true;
+            }
+            pending = kNone;
+            depth++;
+            return true;
+        }
+
+        bool end_object() {
+            depth--;
+            if (inData && depth == 2 && entry.id >= 0) fn(static_cast<const ExtractedEntry&>(entry));
+            if (depth == 3) inCreator = false;
+            return true;
+        }
+
+        bool start_array(std::size_t) {
+            if (depth == 1 && dataKey) inData = true;
+            pending = kNone;
+            depth++;
+            return true;
+        }
+
+        bool end_array() {
+            depth--;
+            if (depth == 1) inData = false;
+            return true;
+        }
+
+        bool key(string_t& val) {
+            pending = kNone;
+            if (depth == 1) {
+                dataKey = (val == "data");
+            } else if (inData && depth == 3) {
+                pending = entrySlot(val);
+            } else if (inCreator && depth == 4) {
+                if (val == "name") pending = kCreatorName;
+                else if (val == "type") pending = kCreatorType;
+            }
+            return true;
+        }
+
+        bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) {
+            return false;
+        }
+
+    private:
+        unsigned fields;
+        Fn& fn;
+        ExtractedEntry entry;
+        int depth = 0;
+        bool dataKey = false;
+        bool inData = false;
+        bool inCreator = false;
+        Slot pending = kNone;
+
+        Slot entrySlot(const string_t& key) const {
+            if (key == "id") return kId;
+            if ((fields & kFieldPlaying) && key == "playing") return kPlaying;
+            if ((fields & kFieldVisits) && key == "visits") return kVisits;
+            if ((fields & kFieldFavorites) && key == "favoritedCount") return kFavorites;
+            if ((fields & kFieldMaxPlayers) && key == "maxPlayers") return kMaxPlayers;
+            if (fields & kFieldVotes) {
+                if (key == "upVotes") return kUpVotes;
+                if (key == "downVotes") return kDownVotes;
+            }
+            if (fields & kFieldMetadata) {
+                if (key == "name") return kName;
+                if (key == "description") return kDescription;
+                if (key == "created") return kCreated;
+                if (key == "creator") return kCreator;
+            }
+            return kNone;
+        }
+
+        void storeNumber(long long val) {
+            switch (pending) {
+                case kId: entry.id = val; break;
+                case kPlaying: entry.playing = val; entry.present |= kFieldPlaying; break;
+                case kVisits: entry.visits = val; entry.present |= kFieldVisits; break;
+                case kFavorites: entry.favoritedCount = val; entry.present |= kFieldFavorites; break;
+                case kMaxPlayers: entry.maxPlayers = val; entry.present |= kFieldMaxPlayers; break;
+                case kUpVotes: entry.upVotes = val; entry.present |= kFieldVotes; break;
+                case kDownVotes: entry.downVotes = val; entry.present |= kFieldVotes; break;
+                default: break;
+            }
+            pending = kNone;
+        }
+    };
+};
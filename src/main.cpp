@@ -1,121 +1,85 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <deque>
 #include <ctime>
 #include <thread>
 #include <chrono>
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
-#include <windows.h>
-#include <wininet.h>
 #include <limits>
-#include "json.hpp"
-using json = nlohmann::json;
-
-// Color helpers for Windows console
-void setColor(WORD color) {
-    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-    SetConsoleTextAttribute(hConsole, color);
-}
-void resetColor() {
-    setColor(7); // Default gray
-}
-
-struct GameData {
-    int ccu;
-    double rating;
-    std::string timestamp;
-};
+#include <unordered_map>
+#include <unordered_set>
+#include <stdexcept>
+#include "console.hpp"
+#include "game_data.hpp"
+#include "game_series.hpp"
+#include "running_stats.hpp"
+#include "batch_fetcher.hpp"
+#include "monitor_engine.hpp"
+#include "watchlist.hpp"
+#include "game_info_cache.hpp"
+#include "sample_store.hpp"
+#include "session_journal.hpp"
+#include "tdigest.hpp"
+#include "drop_detector.hpp"
+#include "sliding_window.hpp"
+#include "seasonal_baseline.hpp"
+#include "series_join.hpp"
+#include "correlation.hpp"
 
 class RobloxGameMonitor {
-private:
-    std::string gameId;
-    int monitorMinutes;
-    std::vector<GameData> dataPoints;
-    bool skipInfoPrint = false;
-    std::vector<std::string> logLines; // NEW
-
 public:
-    struct GameInfo {
-        std::string name;
-        std::string description;
-        std::string created;
-        std::string creatorName;
-        std::string creatorType;
-    };
-
-    RobloxGameMonitor(const std::string& id, int minutes) 
-        : gameId(id), monitorMinutes(minutes), dataPoints() {}
-
-    std::string getCurrentTime() {
-        auto now = std::chrono::system_clock::now();
-        auto time_t = std::chrono::system_clock::to_time_t(now);
-        auto tm = *std::localtime(&time_t);
-
-        std::stringstream ss;
-        ss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
-        return ss.str();
-    }
-
-    std::string httpGet(const std::string& url) {
-        HINTERNET hInternet = InternetOpenA("RobloxMonitor", INTERNET_OPEN_TYPE_DIRECT, NULL, NULL, 0);
-        if (!hInternet) {
-            std::cerr << "InternetOpenA failed. Error: " << GetLastError() << std::endl;
-            return "";
-        }
-
-        HINTERNET hConnect = InternetOpenUrlA(hInternet, url.c_str(), NULL, 0, INTERNET_FLAG_RELOAD, 0);
-        if (!hConnect) {
-            std::cerr << "InternetOpenUrlA failed for URL: " << url << " Error: " << GetLastError() << std::endl;
-            InternetCloseHandle(hInternet);
-            return "";
-        }
-
-        std::string response;
-        char buffer[4096];
-        DWORD bytesRead;
+    // Samples kept in memory per game (one day at one sample per minute).
+    // Older samples only live on in the running stats.
+    static constexpr size_t kHistoryCapacity = 1440;
+    static constexpr size_t kMaxLogLines = 1440;
+    // Poll interval while the upstream refresh period is still being learned
+    static constexpr std::chrono::milliseconds kProbeInterval{5000};
+    // Days of stored daily rollups listed in the results
+    static constexpr int kHistoryDaysShown = 7;
+    // Recent windows summarized on every log line
+    static constexpr int kWindowMinutes[] = {15, 60};
 
-        while (InternetReadFile(hConnect, buffer, sizeof(buffer), &bytesRead) && bytesRead > 0) {
-            response.append(buffer, bytesRead);
-        }
-
-        InternetCloseHandle(hConnect);
-        InternetCloseHandle(hInternet);
-        return response;
+private:
+    std::string gameId;
+    int monitorMinutes; // number of updates instead when countUpdates is set
+    bool countUpdates = false;
+    GameSeries dataPoints;
+    uint64_t missedCount = 0; // ticks whose request failed; they count towards the minutes only
+    SeriesStats stats; // updated with every sample, so reports never rescan dataPoints
+    TDigest ccuDigest; // CCU percentiles without sorting dataPoints
+    DropDetector dropDetector;
+    SlidingWindows windows{windowWidthsMs()}; // only fed for games whose log lines are shown or kept
+    BaselineSummary baselineScores; // samples compared with the store's hour-of-week baseline
+    bool dropAlerts = true; // print drops as they are detected, even without live output
+    std::deque<std::string> logLines; // most recent maxLogLines only
+    size_t maxLogLines = kMaxLogLines;
+    SampleStore* sampleStore = nullptr; // every sample is also persisted here when set
+    std::string logPrefix;
+    WORD logColor = 11;
+
+    GameInfo gameInfo = {"N/A", "N/A", "N/A", "N/A", "N/A"};
+
+    // Counters that only need their first and latest value
+    long long firstVisits = -1, lastVisits = 0;
+    long long firstFavorites = -1, lastFavorites = 0;
+
+    static std::vector<int64_t> windowWidthsMs() {
+        std::vector<int64_t> widths;
+        for (int minutes : kWindowMinutes) widths.push_back(minutes * 60000LL);
+        return widths;
     }
 
-    // Fetch game info from universe API
-    GameInfo fetchGameInfo() {
-        GameInfo info = {"N/A", "N/A", "N/A", "N/A", "N/A"};
-        std::string url = "https://games.roblox.com/v1/games?universeIds=" + gameId;
-        std::string response = httpGet(url);
+public:
+    RobloxGameMonitor(const std::string& id, int minutes, bool countUpdates = false,
+                      size_t historyCapacity = kHistoryCapacity) 
+        : gameId(id), monitorMinutes(minutes), countUpdates(countUpdates), dataPoints(historyCapacity) {}
 
-        if (!response.empty()) {
-            try {
-                json root = json::parse(response);
-                if (root.contains("data") && root["data"].is_array() && !root["data"].empty()) {
-                    auto gameData = root["data"][0];
-                    if (gameData.contains("name"))
-                        info.name = gameData["name"].get<std::string>();
-                    if (gameData.contains("description"))
-                        info.description = gameData["description"].get<std::string>();
-                    if (gameData.contains("created"))
-                        info.created = gameData["created"].get<std::string>();
-                    if (gameData.contains("creator") && gameData["creator"].is_object()) {
-                        auto creator = gameData["creator"];
-                        if (creator.contains("name"))
-                            info.creatorName = creator["name"].get<std::string>();
-                        if (creator.contains("type"))
-                            info.creatorType = creator["type"].get<std::string>();
-                    }
-                }
-            } catch (...) {
-                // ignore parse errors
-            }
-        }
-        return info;
-    }
+    // Reuse info that was already fetched (e.g. during validation)
+    void setGameInfo(const GameInfo& info) { gameInfo = info; }
+    const GameInfo& getGameInfo() const { return gameInfo; }
 
     // Print game info table
     void printGameInfoTable(const GameInfo& info, WORD color = 11) {
@@ -127,121 +91,201 @@ public:
         std::cout << "Name:        " << info.name << std::endl;
         std::cout << "Created:     " << info.created << std::endl;
         std::cout << "Creator:     " << info.creatorName << " (" << info.creatorType << ")" << std::endl;
+        std::cout << "Max Players: " << info.maxPlayers << std::endl;
         std::cout << "Description: " << info.description << std::endl;
         setColor(color);
         std::cout << std::string(60, '=') << std::endl << std::endl;
         resetColor();
     }
 
-
-    GameData fetchGameData() {
-        GameData data = {0, 0.0, getCurrentTime()};
-        
-        // Only use Universe ID endpoints
-        std::string universeUrl = "https://games.roblox.com/v1/games?universeIds=" + gameId;
-        std::string universeResponse = httpGet(universeUrl);
-        
-        if (!universeResponse.empty()) {
-            try {
-                json universeRoot = json::parse(universeResponse);
-                if (universeRoot.contains("data") && universeRoot["data"].is_array() && !universeRoot["data"].empty()) {
-                    auto gameData = universeRoot["data"][0];
-                    if (gameData.contains("playing")) {
-                        data.ccu = gameData["playing"].get<int>();
-                    }
-                }
-            } catch (const std::exception& e) {
-                // Handle parsing error
-            }
+    void setLogStyle(const std::string& prefix, WORD color) { logPrefix = prefix; logColor = color; }
+    // 0 keeps no log lines (large watchlists)
+    void setMaxLogLines(size_t lines) { maxLogLines = lines; }
+    void setSampleStore(SampleStore* store) { sampleStore = store; }
+    void setDropAlerts(bool alerts) { dropAlerts = alerts; }
+
+    const std::string& getGameId() const { return gameId; }
+    int getMonitorMinutes() const { return monitorMinutes; }
+    // Samples are distinct CCU updates rather than one per minute
+    bool countsUpdates() const { return countUpdates; }
+    const char* sampleLabel() const { return countUpdates ? "Update" : "Minute"; }
+    // monitorMinutes <= 0 means run until stopped
+    bool runsForever() const { return monitorMinutes <= 0; }
+    // Samples recorded plus ticks missed, i.e. minutes (or updates) so far
+    uint64_t samplesSeen() const { return dataPoints.totalCount() + missedCount; }
+    bool isComplete() const { return !runsForever() && samplesSeen() >= (uint64_t)monitorMinutes; }
+
+    // Stores the sample of a snapshot that did not fail, and its log line.
+    // Without votes its CCU still counts, but it has no rating.
+    void recordSample(const GameSnapshot& snapshot, bool liveOutput = true) {
+        const GameData& data = snapshot.data;
+        stats.add(data, dataPoints.totalCount(), snapshot.hasVotes);
+        ccuDigest.add(data.ccu);
+        dataPoints.push_back(data);
+        if (sampleStore) {
+            sampleStore->append(gameId, snapshot);
+            BaselineScore score;
+            const SeasonalBaseline* baseline = sampleStore->baseline(gameId);
+            if (baseline && baseline->score(data, score)) baselineScores.add(score);
         }
+        logSample(data, snapshot.hasVotes, liveOutput);
+        DropDetector::Event event = dropDetector.add(snapshot);
+        if (event != DropDetector::kNone && dropAlerts) printDrop(event);
+    }
 
-        // Get votes for rating (Universe ID endpoint)
-        std::string voteUrl = "https://games.roblox.com/v1/games/votes?universeIds=" + gameId;
-        std::string voteResponse = httpGet(voteUrl);
-        
-        if (!voteResponse.empty()) {
-            try {
-                json voteRoot = json::parse(voteResponse);
-                if (voteRoot.contains("data") && voteRoot["data"].is_array() && !voteRoot["data"].empty()) {
-                    auto voteData = voteRoot["data"][0];
-                    if (voteData.contains("upVotes") && voteData.contains("downVotes")) {
-                        int upVotes = voteData["upVotes"].get<int>();
-                        int downVotes = voteData["downVotes"].get<int>();
-                        int totalVotes = upVotes + downVotes;
-                        if (totalVotes > 0) {
-                            data.rating = (double(upVotes) / totalVotes) * 100.0;
-                        }
-                    }
-                }
-            } catch (const std::exception& e) {
-                // Handle parsing error
-            }
+    // Alert line for a drop that just started or ended
+    void printDrop(DropDetector::Event event) const {
+        const DropDetector::Drop& drop = dropDetector.drop();
+        std::ostringstream oss;
+        oss << (logPrefix.empty() ? "[" + gameInfo.name + "]" : logPrefix) << std::fixed;
+        if (event == DropDetector::kDropStarted) {
+            oss << " CCU DROP: " << drop.startCcu << " -> " << drop.lowCcu
+                << " (-" << (long long)drop.magnitude() << ", -" << std::setprecision(1) << drop.percent() << "%)"
+                << " since " << formatTimestamp(drop.startMs)
+                << ", " << drop.slopePerMinute() << " CCU/min [" << formatTimestamp(drop.lastMs) << "]";
+        } else {
+            oss << " CCU drop over: " << (drop.recovered ? "back to " : "settled at ") << drop.lastCcu
+                << " after " << std::setprecision(0) << drop.durationMinutes() << " min"
+                << " (low " << drop.lowCcu << ", -" << std::setprecision(1) << drop.percent() << "%)";
         }
-
-        return data;
+        setColor(event == DropDetector::kDropStarted ? 12 : logColor);
+        std::cout << oss.str() << std::endl;
+        resetColor();
     }
 
-    void setSkipInfoPrint(bool skip) { skipInfoPrint = skip; }
+    // Prints and/or keeps the log line of the sample just pushed, with the
+    // low, peak and average of the last kWindowMinutes
+    void logSample(const GameData& data, bool hasVotes, bool liveOutput) {
+        if (!liveOutput && maxLogLines == 0) return;
+        windows.add(data, hasVotes);
 
-    // Store logs instead of printing
-    void startMonitoring(const std::string& logPrefix = "", WORD logColor = 11, bool liveOutput = true) {
-        if (!skipInfoPrint) {
-            GameInfo info = fetchGameInfo();
-            printGameInfoTable(info);
+        std::ostringstream oss;
+        oss << sampleHeader() << "CCU: " << data.ccu << ", Rating: " << std::fixed << std::setprecision(1);
+        if (hasVotes)
+            oss << data.rating() << "%";
+        else
+            oss << "N/A (votes request failed)";
+        oss << " [" << formatTimestamp(data.timestampMs) << "]";
+        for (size_t i = 0; i < windows.windowCount(); i++) {
+            SlidingWindows::Summary window = windows.summary(i);
+            oss << " | " << windows.widthMs(i) / 60000 << "m CCU " << window.minCcu << "-" << window.maxCcu
+                << " (avg " << std::setprecision(0) << window.meanCcu << ")";
+            if (window.ratingCount > 0) {
+                oss << " Rating " << std::setprecision(1) << window.minRating << "-" << window.maxRating
+                    << "% (avg " << window.meanRating << "%)";
+            }
+        }
+        const VoteVelocity& votes = stats.votes;
+        if (votes.hasIntervals() && votes.lastMs == data.timestampMs) {
+            const VoteInterval& interval = votes.latest;
+            double likes;
+            oss << " | votes " << std::showpos << interval.upDelta << " up " << interval.downDelta << " down"
+                << std::noshowpos << " (" << std::setprecision(1) << interval.perMinute() << "/min";
+            if (interval.likeRatio(likes)) oss << ", " << likes << "% likes";
+            oss << ")";
+        }
+        if (!baselineScores.empty() && baselineScores.last.timeMs == data.timestampMs) {
+            const BaselineScore& score = baselineScores.last;
+            oss << " | usual " << std::setprecision(0) << score.expected << " (" << std::showpos
+                << std::setprecision(1) << score.percent() << "%" << std::noshowpos << ")";
         }
 
-        int minute = 0;
+        if (liveOutput) {
+            setColor(logColor);
+            std::cout << oss.str() << std::endl;
+            resetColor();
+        }
 
-        std::cout << "Waiting 1 minute before first sample...\n";
-        std::this_thread::sleep_for(std::chrono::seconds(60));
+        if (maxLogLines == 0) return;
+        logLines.push_back(oss.str());
+        if (logLines.size() > maxLogLines) logLines.pop_front();
+    }
 
-        while (minute < monitorMinutes) {
-            GameData data = fetchGameData();
-            dataPoints.push_back(data);
+    // " Minute 3/10 - " in front of a log line
+    std::string sampleHeader() const {
+        std::ostringstream oss;
+        if (runsForever())
+            oss << logPrefix << " Sample " << samplesSeen() << " - ";
+        else
+            oss << logPrefix << " " << sampleLabel() << " " << samplesSeen() << "/" << monitorMinutes << " - ";
+        return oss.str();
+    }
 
-            std::ostringstream oss;
-            oss << logPrefix << " Minute " << (minute + 1) << "/" << monitorMinutes << " - "
-                << "CCU: " << data.ccu
-                << ", Rating: " << std::fixed << std::setprecision(1) << data.rating << "%"
-                << " [" << data.timestamp << "]";
+    // A tick without data: it uses up its minute, but nothing is recorded
+    void recordMissed(const GameData& data, bool liveOutput) {
+        missedCount++;
+        if (!liveOutput && maxLogLines == 0) return;
+        std::string line = sampleHeader() + "no data (request failed) [" + formatTimestamp(data.timestampMs) + "]";
+        if (liveOutput) {
+            setColor(logColor);
+            std::cout << line << std::endl;
+            resetColor();
+        }
+        if (maxLogLines == 0) return;
+        logLines.push_back(line);
+        if (logLines.size() > maxLogLines) logLines.pop_front();
+    }
 
-            if (liveOutput) {
-                setColor(logColor);
-                std::cout << oss.str() << std::endl;
-                resetColor();
-            }
+    // Stores the sample and refreshes metadata from the same response
+    void recordSnapshot(const GameSnapshot& snapshot, bool liveOutput = true) {
+        if (snapshot.failed) {
+            recordMissed(snapshot.data, liveOutput);
+            return;
+        }
+        if (snapshot.hasInfo) setGameInfo(snapshot.info);
+        if (snapshot.visits > 0) {
+            if (firstVisits < 0) firstVisits = snapshot.visits;
+            lastVisits = snapshot.visits;
+        }
+        if (snapshot.favoritedCount > 0) {
+            if (firstFavorites < 0) firstFavorites = snapshot.favoritedCount;
+            lastFavorites = snapshot.favoritedCount;
+        }
+        recordSample(snapshot, liveOutput);
+    }
 
-            logLines.push_back(oss.str());
-            minute++;
+    MonitorState saveState() const {
+        return MonitorState{dataPoints.totalCount(), stats, firstVisits, lastVisits, firstFavorites, lastFavorites,
+                            dropDetector, baselineScores, missedCount};
+    }
 
-            if (minute < monitorMinutes) {
-                std::this_thread::sleep_for(std::chrono::seconds(60)); // fixed interval
-            }
+    // Continues an interrupted session: counters, stats and the digest come
+    // from the journal, the retained history (and its log lines) from
+    // history, the stored samples of this session oldest first
+    void restoreState(const MonitorState& state, const TDigest& digest, const std::vector<GameData>& history) {
+        stats = state.stats;
+        ccuDigest = digest;
+        firstVisits = state.firstVisits;
+        lastVisits = state.lastVisits;
+        firstFavorites = state.firstFavorites;
+        lastFavorites = state.lastFavorites;
+        dropDetector = state.drops;
+        baselineScores = state.baselineScores;
+        missedCount = state.missedCount;
+
+        size_t keep = std::min<size_t>(history.size(), (size_t)state.totalCount);
+        if (dataPoints.getCapacity() > 0) keep = std::min(keep, dataPoints.getCapacity());
+        dataPoints = GameSeries(dataPoints.getCapacity());
+        dataPoints.skip(state.totalCount - keep);
+        logLines.clear();
+        windows.clear();
+        for (size_t i = history.size() - keep; i < history.size(); i++) {
+            dataPoints.push_back(history[i]);
+            logSample(history[i], history[i].hasVotes(), false);
         }
-        // Do NOT call showResults() here!
     }
 
     // Returns average CCU
-    double getAverageCCU() const {
-        if (dataPoints.empty()) return 0.0;
-        int sum = 0;
-        for (const auto& d : dataPoints) sum += d.ccu;
-        return static_cast<double>(sum) / dataPoints.size();
-    }
+    double getAverageCCU() const { return stats.ccu.mean; }
 
     // Returns index of peak CCU
-    size_t getPeakCCUIndex() const {
-        if (dataPoints.empty()) return 0;
-        return std::distance(dataPoints.begin(), std::max_element(dataPoints.begin(), dataPoints.end(),
-            [](const GameData& a, const GameData& b) { return a.ccu < b.ccu; }));
-    }
+    size_t getPeakCCUIndex() const { return stats.ccu.maxIndex; }
 
     // Returns index of lowest CCU
-    size_t getLowestCCUIndex() const {
-        if (dataPoints.empty()) return 0;
-        return std::distance(dataPoints.begin(), std::min_element(dataPoints.begin(), dataPoints.end(),
-            [](const GameData& a, const GameData& b) { return a.ccu < b.ccu; }));
-    }
+    size_t getLowestCCUIndex() const { return stats.ccu.minIndex; }
+
+    const SeriesStats& getStats() const { return stats; }
+    const TDigest& getCcuDigest() const { return ccuDigest; }
 
     void showResults(const std::string& gameName = "") {
         setColor(10); // Green
@@ -255,242 +299,942 @@ public:
             return;
         }
 
-        // Find CCU peaks
-        auto ccuMinMax = std::minmax_element(dataPoints.begin(), dataPoints.end(),
-            [](const GameData& a, const GameData& b) { return a.ccu < b.ccu; });
-        size_t peakIdx = getPeakCCUIndex();
-        size_t lowIdx = getLowestCCUIndex();
-
-        // Find rating peaks
-        auto ratingMinMax = std::minmax_element(dataPoints.begin(), dataPoints.end(),
-            [](const GameData& a, const GameData& b) { return a.rating < b.rating; });
+        const FieldStats& ccu = stats.ccu;
+        const FieldStats& rating = stats.rating;
 
         // Display summary
         if (!gameName.empty())
             std::cout << "Game: " << gameName << std::endl;
         std::cout << "Game ID: " << gameId << std::endl;
-        std::cout << "Monitoring Duration: " << monitorMinutes << " minutes" << std::endl;
-        std::cout << "Total Data Points: " << dataPoints.size() << std::endl;
+        if (runsForever())
+            std::cout << "Monitoring Duration: until stopped" << std::endl;
+        else if (countUpdates)
+            std::cout << "Monitoring Duration: " << monitorMinutes << " CCU updates" << std::endl;
+        else
+            std::cout << "Monitoring Duration: " << monitorMinutes << " minutes" << std::endl;
+        std::cout << "Total Data Points: " << dataPoints.totalCount() << std::endl;
+        if (missedCount > 0) std::cout << "Missed Samples: " << missedCount << " (request failed)" << std::endl;
+        if (dataPoints.size() < dataPoints.totalCount())
+            std::cout << "Retained Data Points: " << dataPoints.size() << " (most recent)" << std::endl;
 
         setColor(14); // Yellow for section headers
         std::cout << "\nCONCURRENT USERS (CCU) ANALYSIS:" << std::endl;
         resetColor();
-        if (!dataPoints.empty()) {
-            std::cout << "Starting CCU: " << dataPoints.front().ccu 
-                      << " [" << dataPoints.front().timestamp << "]" << std::endl;
-            std::cout << "Ending CCU: " << dataPoints.back().ccu 
-                      << " [" << dataPoints.back().timestamp << "]" << std::endl;
-        }
-        std::cout << "Lowest CCU: " << ccuMinMax.first->ccu 
-                  << " [" << ccuMinMax.first->timestamp << "] (Minute " << (lowIdx+1) << ")" << std::endl;
-        std::cout << "Highest CCU: " << ccuMinMax.second->ccu 
-                  << " [" << ccuMinMax.second->timestamp << "] (Minute " << (peakIdx+1) << ")" << std::endl;
-        std::cout << "CCU Average: " << std::fixed << std::setprecision(2) << getAverageCCU() << std::endl;
-
-        int ccuChange = (!dataPoints.empty()) ? (dataPoints.back().ccu - dataPoints.front().ccu) : 0;
+        std::cout << "Starting CCU: " << (long long)ccu.first 
+                  << " [" << formatTimestamp(ccu.firstTimeMs) << "]" << std::endl;
+        std::cout << "Ending CCU: " << (long long)ccu.last 
+                  << " [" << formatTimestamp(ccu.lastTimeMs) << "]" << std::endl;
+        std::cout << "Lowest CCU: " << (long long)ccu.min 
+                  << " [" << formatTimestamp(ccu.minTimeMs) << "] (" << sampleLabel() << " " << (ccu.minIndex+1) << ")" << std::endl;
+        std::cout << "Highest CCU: " << (long long)ccu.max 
+                  << " [" << formatTimestamp(ccu.maxTimeMs) << "] (" << sampleLabel() << " " << (ccu.maxIndex+1) << ")" << std::endl;
+        std::cout << "CCU Average: " << std::fixed << std::setprecision(2) << ccu.mean << std::endl;
+        std::cout << "CCU Std Dev: " << std::fixed << std::setprecision(2) << ccu.stddev() << std::endl;
+        std::cout << "CCU Percentiles: p50 " << std::setprecision(0) << ccuDigest.quantile(0.5)
+                  << ", p90 " << ccuDigest.quantile(0.9) << ", p99 " << ccuDigest.quantile(0.99) << std::endl;
+
+        std::cout << "CCU Drops Detected: " << dropDetector.getDropCount();
+        if (const DropDetector::Drop* largest = dropDetector.largestDrop()) {
+            std::cout << " (largest: " << largest->startCcu << " -> " << largest->lowCcu << ", -"
+                      << std::setprecision(1) << largest->percent() << "% from " << formatTimestamp(largest->startMs) << ")";
+        }
+        std::cout << std::endl;
+
+        long long ccuChange = (long long)ccu.change();
         std::cout << "Net CCU Change: " << (ccuChange >= 0 ? "+" : "") << ccuChange;
-        if (!dataPoints.empty() && dataPoints.front().ccu != 0) {
+        if (ccu.first != 0) {
             std::cout << " (" << std::fixed << std::setprecision(1)
-                      << ((double)ccuChange / dataPoints.front().ccu * 100) << "%)";
+                      << ((double)ccuChange / ccu.first * 100) << "%)";
         } else {
             std::cout << " (N/A%)";
         }
         std::cout << std::endl;
+        if (firstVisits >= 0)
+            std::cout << "Visits Gained: +" << (lastVisits - firstVisits) << std::endl;
+        if (firstFavorites >= 0)
+            std::cout << "Favorites Gained: " << std::showpos << (lastFavorites - firstFavorites)
+                      << std::noshowpos << std::endl;
 
         setColor(14);
         std::cout << "\nRATING ANALYSIS:" << std::endl;
         resetColor();
-        if (!dataPoints.empty()) {
-            std::cout << "Starting Rating: " << std::fixed << std::setprecision(1) 
-                      << dataPoints.front().rating << "% [" << dataPoints.front().timestamp << "]" << std::endl;
-            std::cout << "Ending Rating: " << dataPoints.back().rating 
-                      << "% [" << dataPoints.back().timestamp << "]" << std::endl;
-        }
-        std::cout << "Lowest Rating: " << ratingMinMax.first->rating 
-                  << "% [" << ratingMinMax.first->timestamp << "]" << std::endl;
-        std::cout << "Highest Rating: " << ratingMinMax.second->rating 
-                  << "% [" << ratingMinMax.second->timestamp << "]" << std::endl;
-        
-        double ratingChange = (!dataPoints.empty()) ? (dataPoints.back().rating - dataPoints.front().rating) : 0.0;
-        std::cout << "Net Rating Change: " << (ratingChange >= 0 ? "+" : "") 
-                  << std::setprecision(2) << ratingChange << "%" << std::endl;
+        if (rating.empty()) {
+            std::cout << "No rating data (every votes request failed)" << std::endl;
+        } else {
+            std::cout << "Starting Rating: " << std::fixed << std::setprecision(1)
+                      << rating.first << "% [" << formatTimestamp(rating.firstTimeMs) << "]" << std::endl;
+            std::cout << "Ending Rating: " << rating.last
+                      << "% [" << formatTimestamp(rating.lastTimeMs) << "]" << std::endl;
+            std::cout << "Lowest Rating: " << rating.min
+                      << "% [" << formatTimestamp(rating.minTimeMs) << "]" << std::endl;
+            std::cout << "Highest Rating: " << rating.max
+                      << "% [" << formatTimestamp(rating.maxTimeMs) << "]" << std::endl;
+
+            double ratingChange = rating.change();
+            std::cout << "Net Rating Change: " << (ratingChange >= 0 ? "+" : "")
+                      << std::setprecision(2) << ratingChange << "%" << std::endl;
+        }
+        const VoteVelocity& votes = stats.votes;
+        if (votes.hasIntervals()) {
+            VoteInterval total = votes.total();
+            double likes;
+            std::cout << "Votes Gained: " << std::showpos << total.upDelta << " likes, " << total.downDelta
+                      << " dislikes" << std::noshowpos << " (" << std::setprecision(2) << total.perMinute()
+                      << " votes/min)" << std::endl;
+            if (total.likeRatio(likes)) {
+                std::cout << "Like Ratio of New Votes: " << std::setprecision(1) << likes << "% (overall "
+                          << rating.last << "%)" << std::endl;
+            }
+            std::cout << "Fastest Voting: " << std::setprecision(2) << votes.fastest.perMinute() << " votes/min ["
+                      << formatTimestamp(votes.fastestEndMs - votes.fastest.spanMs) << " - "
+                      << formatTimestamp(votes.fastestEndMs) << "]" << std::endl;
+        }
+
+        if (sampleStore) {
+            // Read from the daily rollups, so this covers earlier sessions too
+            int64_t fromMs = nowEpochMs() - (int64_t)kHistoryDaysShown * kRollupTiers[kRollup1Day].widthMs;
+            std::vector<RollupBucket> days = sampleStore->readRollups(gameId, kRollup1Day, fromMs);
+            if (!days.empty()) {
+                setColor(14);
+                std::cout << "\nDAILY CCU HISTORY (UTC days, stored samples):" << std::endl;
+                resetColor();
+                for (const auto& day : days) {
+                    std::cout << formatUtcDate(day.startMs) << ": Peak " << day.max << ", Low " << day.min
+                              << ", Average " << std::fixed << std::setprecision(2) << day.mean()
+                              << " (" << day.count << " samples)" << std::endl;
+                }
+                // Merged from the stored day digests
+                TDigest week = sampleStore->readCcuDigest(gameId, fromMs);
+                std::cout << "Percentiles over these days: p50 " << std::setprecision(0) << week.quantile(0.5)
+                          << ", p90 " << week.quantile(0.9) << ", p99 " << week.quantile(0.99) << std::endl;
+            }
+
+            setColor(14);
+            std::cout << "\nVERSUS USUAL (hour-of-week baseline from stored samples):" << std::endl;
+            resetColor();
+            if (baselineScores.empty()) {
+                std::cout << "No baseline yet, it is learned from completed hours of stored samples." << std::endl;
+            } else {
+                auto printScore = [](const char* label, const BaselineScore& score) {
+                    std::cout << label << score.ccu << " vs usual " << std::setprecision(0) << score.expected
+                              << " for " << SeasonalBaseline::slotLabel(score.timeMs) << " (" << std::showpos
+                              << std::setprecision(1) << score.percent() << "%, z " << std::setprecision(2) << score.z()
+                              << std::noshowpos << ") [" << formatTimestamp(score.timeMs) << "]" << std::endl;
+                };
+                printScore("Latest: ", baselineScores.last);
+                printScore("Furthest Below Usual: ", baselineScores.lowest);
+                printScore("Furthest Above Usual: ", baselineScores.highest);
+            }
+        }
 
         setColor(13); // Magenta for detailed points
         std::cout << "\nDETAILED DATA POINTS:" << std::endl;
         std::cout << std::string(60, '-') << std::endl;
         for (size_t i = 0; i < dataPoints.size(); i++) {
-            std::cout << "Point " << (i + 1) << ": CCU=" << dataPoints[i].ccu 
-                      << ", Rating=" << std::fixed << std::setprecision(1) << dataPoints[i].rating 
-                      << "% [" << dataPoints[i].timestamp << "]" << std::endl;
+            GameData point = dataPoints[i];
+            std::cout << "Point " << (dataPoints.firstRetainedIndex() + i + 1) << ": CCU=" << point.ccu << ", Rating=";
+            if (point.hasVotes())
+                std::cout << std::fixed << std::setprecision(1) << point.rating() << "%";
+            else
+                std::cout << "N/A";
+            std::cout << " [" << formatTimestamp(point.timestampMs) << "]" << std::endl;
         }
         setColor(10);
         std::cout << std::string(60, '=') << std::endl;
         resetColor();
     }
 
-    const std::vector<GameData>& getDataPoints() const { return dataPoints; }
+    const GameSeries& getDataPoints() const { return dataPoints; }
     // Getter for log lines
-    const std::vector<std::string>& getLogLines() const { return logLines; }
+    const std::deque<std::string>& getLogLines() const { return logLines; }
 };
 
-int main() {
+// Samples every monitor once per minute from a single engine thread. Each
+// tick sends one games request and one votes request per chunk of the
+// watchlist, all in flight at the same time. With countUpdates, monitors
+// are sampled on each upstream CCU update instead. With a store, each
+// tick's samples are persisted once the tick is done.
+//
+// A journal (which needs the store) gets every tick first, as one synced
+// write, so the per-game files are only synced at its checkpoints.
+// resumed continues an interrupted session: monitors are restored from
+// its checkpoint, the ticks logged after the checkpoint are replayed, and
+// sampling goes on at the tick that was due. Only monitors with live
+// output read their retained history back from the store; the others
+// only ever report their running stats.
+void runMonitors(const std::vector<RobloxGameMonitor*>& monitors, bool countUpdates = false, bool liveOutput = true,
+                 SampleStore* store = nullptr, SessionJournal* journal = nullptr,
+                 const SessionJournal::Recovered* resumed = nullptr) {
+    if (!store) journal = nullptr;
+    for (auto* monitor : monitors) monitor->setSampleStore(store);
+
+    int64_t firstTickMs = 0;
+    if (resumed) {
+        for (size_t i = 0; i < monitors.size() && i < resumed->states.size(); i++) {
+            const MonitorState& state = resumed->states[i];
+            std::vector<GameData> history;
+            if (store && liveOutput && !state.stats.ccu.empty()) {
+                history = store->readSeries(monitors[i]->getGameId(), state.stats.ccu.firstTimeMs);
+                // Newer samples are replayed from the log below
+                while (!history.empty() && history.back().timestampMs > state.stats.ccu.lastTimeMs) history.pop_back();
+            }
+            monitors[i]->restoreState(state, resumed->digests[i], history);
+        }
+        // Drops in the replayed ticks were already reported before the interruption
+        for (auto* monitor : monitors) monitor->setDropAlerts(false);
+        for (const auto& tick : resumed->ticks) {
+            for (const auto& entry : tick.entries)
+                if (entry.index < monitors.size()) monitors[entry.index]->recordSnapshot(entry.toSnapshot(), false);
+        }
+        for (auto* monitor : monitors) monitor->setDropAlerts(true);
+        firstTickMs = resumed->nextTickMs;
+    }
 
-    SetConsoleOutputCP(CP_UTF8);   // ✅ add this line here
+    std::vector<SessionJournal::Entry> tickEntries;
+    size_t ticksSinceCheckpoint = resumed ? resumed->ticks.size() : 0;
+    bool reportedJournalError = false;
+    auto reportJournalError = [&]() {
+        if (reportedJournalError) return;
+        std::cerr << "Could not write the session journal to " << store->getDirectory() << std::endl;
+        reportedJournalError = true;
+    };
+    // The logged ticks may only be dropped once their samples are on disk
+    auto checkpoint = [&](int64_t nextTickMs) {
+        ticksSinceCheckpoint = 0;
+        if (!store->flush() || !store->sync()) return;
+        std::vector<MonitorState> states;
+        std::vector<const TDigest*> digests;
+        states.reserve(monitors.size());
+        digests.reserve(monitors.size());
+        for (const auto* monitor : monitors) {
+            states.push_back(monitor->saveState());
+            digests.push_back(&monitor->getCcuDigest());
+        }
+        if (!journal->checkpoint(nextTickMs, states, digests)) reportJournalError();
+    };
+    if (journal) {
+        store->setSyncWrites(false);
+        // A new session writes its settings; a resumed one is still logged
+        if (!resumed) checkpoint(firstTickMs);
+    }
 
-    setColor(11); // Cyan
-    std::cout << "Roblox Game Monitoring Tool" << std::endl;
-    std::cout << std::string(40, '=') << std::endl;
-    resetColor();
+    MonitorEngine engine;
+    engine.setTickCallback([&]() {
+        // Every scheduled tick is logged, even one without entries, so its
+        // next tick time survives a crash; a poll in update mode only when
+        // it recorded something
+        if (journal && (!countUpdates || !tickEntries.empty())) {
+            if (!journal->append(engine.nextTickMs(), tickEntries)) {
+                reportJournalError();
+                store->flush();
+                store->sync();
+            }
+            tickEntries.clear();
+            ticksSinceCheckpoint++;
+        }
+        if (store) store->flush();
+        if (journal && ticksSinceCheckpoint >= SessionJournal::kCheckpointTicks) checkpoint(engine.nextTickMs());
+    });
+    for (size_t i = 0; i < monitors.size(); i++) {
+        RobloxGameMonitor* monitor = monitors[i];
+        if (monitor->isComplete()) continue; // finished before the session was interrupted
+        const FieldStats& ccu = monitor->getStats().ccu;
+        engine.watch(monitor->getGameId(), [monitor, liveOutput, journal, i, &tickEntries](const GameSnapshot& snapshot) {
+            monitor->recordSnapshot(snapshot, liveOutput);
+            // Missed ticks are logged too: they count towards the duration
+            if (journal) tickEntries.push_back(SessionJournal::Entry::from((uint32_t)i, snapshot));
+            return !monitor->isComplete();
+        }, ccu.empty() ? -1 : (int64_t)ccu.last);
+    }
+    if (engine.activeCount() > 0) {
+        if (countUpdates)
+            engine.runOnChange(RobloxGameMonitor::kProbeInterval);
+        else
+            engine.run(std::chrono::seconds(60), firstTickMs);
+    }
 
-    std::string compareModeInput;
-    std::cout << "Initiate compare mode? (y/n): ";
-    std::getline(std::cin, compareModeInput);
+    if (journal) {
+        // Finished or stopped with Ctrl+C: nothing left to resume
+        if (store->flush() && store->sync()) journal->finish();
+    }
+}
 
-    bool compareMode = (compareModeInput.size() > 0 && (compareModeInput[0] == 'y' || compareModeInput[0] == 'Y'));
+// Watchlists up to this size get info tables, live log lines and full
+// per-game results; larger ones only get the comparison summary
+constexpr size_t kDetailedGamesMax = 10;
+// Games listed per ranking in the comparison summary
+constexpr size_t kRankedGamesShown = 10;
+// Samples kept in memory across the whole watchlist. Per-game history
+// shrinks as the watchlist grows so memory stays bounded.
+constexpr size_t kWatchlistSampleBudget = 1000000;
+constexpr size_t kMinHistoryCapacity = 60;
+const WORD kGameColors[] = {9, 12, 10, 13, 14, 11};
+
+size_t historyCapacityFor(size_t games) {
+    size_t perGame = kWatchlistSampleBudget / std::max<size_t>(games, 1);
+    return std::max(kMinHistoryCapacity, std::min(RobloxGameMonitor::kHistoryCapacity, perGame));
+}
 
-    auto isGameInfoValid = [](const RobloxGameMonitor::GameInfo& info) {
-        return info.name != "N/A" && info.created != "N/A" && info.creatorName != "N/A";
+// Ranks every game by average, peak and lowest CCU. Only the top entries
+// of each ranking are sorted (partial sort), so it stays fast for
+// thousands of games.
+void printComparisonSummary(const std::vector<RobloxGameMonitor*>& monitors, int duration, bool countUpdates) {
+    setColor(10);
+    std::cout << "\n\n=== COMPARISON SUMMARY ===\n";
+    std::cout << std::string(60, '=') << std::endl;
+    resetColor();
+    std::cout << "Games: " << monitors.size() << std::endl;
+    if (monitors.size() <= kDetailedGamesMax) {
+        for (size_t i = 0; i < monitors.size(); i++)
+            std::cout << "Game " << (i + 1) << ": " << monitors[i]->getGameInfo().name << std::endl;
+    }
+    if (duration > 0)
+        std::cout << "Monitoring Duration: " << duration << (countUpdates ? " CCU updates" : " minutes") << std::endl;
+    else
+        std::cout << "Monitoring Duration: until stopped" << std::endl;
+
+    enum RankBy { kByAverage, kByMedian, kByPeak, kByLow };
+    // Medians are estimated once per game, not once per comparison
+    std::vector<double> medians(monitors.size());
+    for (size_t i = 0; i < monitors.size(); i++) medians[i] = monitors[i]->getCcuDigest().quantile(0.5);
+    auto value = [&](size_t i, RankBy by) {
+        const FieldStats& ccu = monitors[i]->getStats().ccu;
+        return by == kByAverage ? ccu.mean : by == kByMedian ? medians[i] : by == kByPeak ? ccu.max : ccu.min;
     };
 
-    if (compareMode) {
-        std::string gameId1, gameId2;
-        int minutes;
+    size_t shown = std::min(monitors.size(), kRankedGamesShown);
+    std::vector<size_t> order(monitors.size());
+    auto rank = [&](const char* title, RankBy by) {
+        for (size_t i = 0; i < order.size(); i++) order[i] = i;
+        // Highest first; games without data go last
+        std::partial_sort(order.begin(), order.begin() + shown, order.end(), [&](size_t a, size_t b) {
+            const FieldStats& ccuA = monitors[a]->getStats().ccu;
+            const FieldStats& ccuB = monitors[b]->getStats().ccu;
+            if (ccuA.empty() || ccuB.empty()) return !ccuA.empty() && ccuB.empty();
+            return value(a, by) > value(b, by);
+        });
+
+        std::cout << "\n" << title;
+        if (shown < monitors.size()) std::cout << " (top " << shown << " of " << monitors.size() << ")";
+        std::cout << ":\n";
+        for (size_t r = 0; r < shown; r++) {
+            const RobloxGameMonitor& monitor = *monitors[order[r]];
+            const FieldStats& ccu = monitor.getStats().ccu;
+            std::cout << (r + 1) << ". " << monitor.getGameInfo().name << ": ";
+            if (ccu.empty()) {
+                std::cout << "N/A" << std::endl;
+            } else if (by == kByAverage) {
+                std::cout << std::fixed << std::setprecision(2) << ccu.mean << std::endl;
+            } else if (by == kByMedian) {
+                const TDigest& digest = monitor.getCcuDigest();
+                std::cout << std::fixed << std::setprecision(0) << medians[order[r]]
+                          << " (p90 " << digest.quantile(0.9) << ", p99 " << digest.quantile(0.99) << ")" << std::endl;
+            } else {
+                size_t index = by == kByPeak ? ccu.maxIndex : ccu.minIndex;
+                int64_t timeMs = by == kByPeak ? ccu.maxTimeMs : ccu.minTimeMs;
+                std::cout << (long long)value(order[r], by) << " (" << monitor.sampleLabel() << " " << (index + 1)
+                          << ", " << formatTimestamp(timeMs) << ")" << std::endl;
+            }
+        }
+    };
+    rank("CCU Averages", kByAverage);
+    rank("Median CCU", kByMedian);
+    rank("Peak CCU", kByPeak);
+    rank("Lowest CCU", kByLow);
+
+    // Digests merge into one of the same size, so this stays cheap for any
+    // number of games
+    TDigest all;
+    for (const auto* monitor : monitors) all.merge(monitor->getCcuDigest());
+    if (!all.empty()) {
+        std::cout << "\nCCU percentiles across all games: p50 " << std::fixed << std::setprecision(0)
+                  << all.quantile(0.5) << ", p90 " << all.quantile(0.9) << ", p99 " << all.quantile(0.99) << std::endl;
+    }
 
-        // Prompt for first Universe ID and validate
-        while (true) {
-            do {
-                std::cout << "Enter first Roblox Universe ID: ";
-                std::getline(std::cin, gameId1);
-            } while (gameId1.empty());
-            RobloxGameMonitor monitorTest(gameId1, 1);
-            auto infoTest = monitorTest.fetchGameInfo();
-            if (isGameInfoValid(infoTest)) break;
-            setColor(12); // Red
-            std::cout << "Invalid Universe ID (N/A returned). Please try again.\n";
-            resetColor();
+    setColor(10);
+    std::cout << std::string(60, '=') << std::endl;
+    resetColor();
+}
+
+// Monitors every game of the watchlist from one engine and prints the
+// comparison summary. infos[i] is the already validated info of ids[i].
+int runWatchlist(const std::vector<std::string>& ids, const std::vector<GameInfo>& infos,
+                 int duration, bool countUpdates, const SessionJournal::Recovered* resumed = nullptr) {
+    bool detailed = ids.size() <= kDetailedGamesMax;
+    size_t capacity = historyCapacityFor(ids.size());
+
+    std::vector<RobloxGameMonitor> monitors;
+    monitors.reserve(ids.size());
+    std::vector<RobloxGameMonitor*> pointers;
+    for (size_t i = 0; i < ids.size(); i++) {
+        monitors.emplace_back(ids[i], duration, countUpdates, capacity);
+        RobloxGameMonitor& monitor = monitors.back();
+        pointers.push_back(&monitor);
+        monitor.setGameInfo(infos[i]); // already fetched during validation
+        if (!detailed) {
+            monitor.setMaxLogLines(0);
+            continue;
         }
+        WORD color = kGameColors[i % (sizeof(kGameColors) / sizeof(kGameColors[0]))];
+        setColor(color);
+        std::cout << "=== GAME " << (i + 1) << " INFO ===\n";
+        resetColor();
+        monitor.printGameInfoTable(monitor.getGameInfo(), color);
+        monitor.setLogStyle("[GAME " + std::to_string(i + 1) + "]", color);
+    }
+    if (!detailed) {
+        std::cout << "Monitoring " << ids.size() << " games (" << capacity
+                  << " samples kept per game, live output is shown for up to "
+                  << kDetailedGamesMax << " games)." << std::endl;
+    }
 
-        // Prompt for second Universe ID and validate
-        while (true) {
-            do {
-                std::cout << "Enter second Roblox Universe ID: ";
-                std::getline(std::cin, gameId2);
-            } while (gameId2.empty());
-            RobloxGameMonitor monitorTest(gameId2, 1);
-            auto infoTest = monitorTest.fetchGameInfo();
-            if (isGameInfoValid(infoTest)) break;
-            setColor(12);
-            std::cout << "Invalid Universe ID (N/A returned). Please try again.\n";
+    // Monitor all games together, one batched request per endpoint per tick
+    SampleStore store;
+    SessionJournal journal(store.getDirectory());
+    if (resumed) journal.resume(*resumed);
+    else journal.begin(SessionJournal::Config{true, countUpdates, duration, nowEpochMs(), ids});
+    std::cout << "Samples are saved to " << store.getDirectory() << std::endl;
+    runMonitors(pointers, countUpdates, detailed, &store, &journal, resumed);
+
+    if (detailed) {
+        for (size_t i = 0; i < monitors.size(); i++) {
+            setColor(11);
+            std::cout << "\n\n=== GAME " << (i + 1) << " RESULTS ===\n";
             resetColor();
+            monitors[i].showResults(monitors[i].getGameInfo().name);
         }
+    }
+    printComparisonSummary(pointers, duration, countUpdates);
+    return 0;
+}
 
-        std::cout << "Enter monitoring duration (minutes): ";
-        if (!(std::cin >> minutes)) {
-            setColor(12);
-            std::cout << "Invalid input. Please enter a number." << std::endl;
-            resetColor();
-            system("pause");
-            return 1;
+// Monitors one game with live output, then prints its log and results
+int runSingleGame(const std::string& gameId, const GameInfo& info, int duration, bool countUpdates,
+                  const SessionJournal::Recovered* resumed = nullptr) {
+    RobloxGameMonitor monitor(gameId, duration, countUpdates);
+    monitor.setGameInfo(info); // already fetched during validation
+    monitor.printGameInfoTable(info);
+    SampleStore store;
+    SessionJournal journal(store.getDirectory());
+    if (resumed) journal.resume(*resumed);
+    else journal.begin(SessionJournal::Config{false, countUpdates, duration, nowEpochMs(), {gameId}});
+    std::cout << "Samples are saved to " << store.segmentPath(gameId) << std::endl;
+    runMonitors({&monitor}, countUpdates, true, &store, &journal, resumed); // No prefix, default color (cyan)
+    // Print logs after monitoring
+    const auto& logs = monitor.getLogLines();
+    for (const auto& line : logs) {
+        setColor(11);
+        std::cout << line << std::endl;
+        resetColor();
+    }
+    monitor.showResults(info.name);
+
+    setColor(10);
+    std::cout << "\nMonitoring completed successfully!" << std::endl;
+    resetColor();
+    return 0;
+}
+
+bool isGameInfoValid(const GameInfo& info) {
+    return info.name != "N/A" && info.created != "N/A" && info.creatorName != "N/A";
+}
+
+// Checks every ID and splits them into valid IDs with their info and
+// invalid IDs, keeping the input order. Answers come from the on-disk
+// GameInfo cache where possible; the rest are fetched with batched games
+// requests (up to 100 IDs each, all in flight at once) and cached. IDs
+// whose request failed are reported invalid but not cached.
+void validateUniverses(const std::vector<std::string>& ids, std::vector<std::string>& validIds,
+                       std::vector<GameInfo>& validInfos, std::vector<std::string>& invalidIds) {
+    GameInfoCache cache;
+    std::vector<std::string> toFetch;
+    GameInfo info;
+    for (const auto& id : ids) {
+        if (cache.lookup(id, info) == GameInfoCache::kMiss) toFetch.push_back(id);
+    }
+
+    if (!toFetch.empty()) {
+        std::vector<std::string> unanswered;
+        auto results = BatchFetcher().fetchGames(toFetch, &unanswered);
+        std::unordered_set<std::string> failed(unanswered.begin(), unanswered.end());
+        for (const auto& id : toFetch) {
+            auto it = results.find(id);
+            if (it != results.end() && it->second.hasInfo && isGameInfoValid(it->second.info))
+                cache.put(id, it->second.info);
+            else if (!failed.count(id))
+                cache.putInvalid(id);
         }
-        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        if (cache.hasChanges() && !cache.save())
+            std::cerr << "Could not write the game info cache" << std::endl;
+    }
 
-        if (minutes <= 0) {
-            setColor(12);
-            std::cout << "Invalid duration. Please enter a positive number." << std::endl;
-            resetColor();
-            system("pause");
-            return 1;
+    for (const auto& id : ids) {
+        if (cache.lookup(id, info) == GameInfoCache::kValid) {
+            validIds.push_back(id);
+            validInfos.push_back(info);
+        } else {
+            invalidIds.push_back(id);
         }
-        std::cout << std::endl;
+    }
+}
 
-        RobloxGameMonitor monitor1(gameId1, minutes);
-        RobloxGameMonitor monitor2(gameId2, minutes);
+// Lists all invalid IDs in one message
+void reportInvalidIds(const std::vector<std::string>& invalidIds) {
+    if (invalidIds.empty()) return;
+    setColor(12); // Red
+    std::cout << "Invalid Universe ID" << (invalidIds.size() > 1 ? "s" : "") << " (N/A returned):";
+    for (size_t i = 0; i < invalidIds.size(); i++)
+        std::cout << (i == 0 ? " " : ", ") << invalidIds[i];
+    std::cout << std::endl;
+    resetColor();
+}
 
-        // Print game info for both games
-        setColor(11);
-        std::cout << "=== GAME 1 INFO ===\n";
-        resetColor();
-        auto info1 = monitor1.fetchGameInfo();
-        monitor1.printGameInfoTable(info1, 11);  // Cyan
+// Continues an interrupted session with the settings it was started with
+int resumeSession(const SessionJournal::Recovered& recovered) {
+    const SessionJournal::Config& config = recovered.config;
+    if (config.ids.empty()) {
+        std::cerr << "The interrupted session has no games." << std::endl;
+        return 1;
+    }
 
-        setColor(12);
-        std::cout << "=== GAME 2 INFO ===\n";
-        resetColor();
-        auto info2 = monitor2.fetchGameInfo();
-        monitor2.printGameInfoTable(info2, 12);  // Red
+    // Info normally comes straight from the game info cache. Games that are
+    // no longer valid keep their slot, so the journal indexes still match.
+    std::vector<std::string> validIds, invalidIds;
+    std::vector<GameInfo> validInfos;
+    validateUniverses(config.ids, validIds, validInfos, invalidIds);
+    std::unordered_map<std::string, GameInfo> infoById;
+    for (size_t i = 0; i < validIds.size(); i++) infoById[validIds[i]] = validInfos[i];
+    std::vector<GameInfo> infos;
+    infos.reserve(config.ids.size());
+    for (const auto& id : config.ids) {
+        auto it = infoById.find(id);
+        infos.push_back(it != infoById.end() ? it->second : GameInfo{"N/A", "N/A", "N/A", "N/A", "N/A"});
+    }
 
+    setColor(14);
+    std::cout << "Resuming the session started " << formatTimestamp(config.startedMs) << " ("
+              << config.ids.size() << " game" << (config.ids.size() == 1 ? "" : "s") << ")" << std::endl;
+    resetColor();
+    if (config.duration == 0) std::cout << "Running until stopped. Press Ctrl+C to stop and show results.\n";
+    std::cout << std::endl;
 
-        // Prevent duplicate info print in threads
-        monitor1.setSkipInfoPrint(true);
-        monitor2.setSkipInfoPrint(true);
+    if (config.watchlistMode) return runWatchlist(config.ids, infos, config.duration, config.countUpdates, &recovered);
+    return runSingleGame(config.ids[0], infos[0], config.duration, config.countUpdates, &recovered);
+}
 
-        // Monitor both games in parallel, store logs only
-        std::thread t1([&monitor1]() { monitor1.startMonitoring("[GAME 1]", 9); }); // Blue
-        std::thread t2([&monitor2]() { 
-            std::this_thread::sleep_for(std::chrono::milliseconds(500));
-            monitor2.startMonitoring("[GAME 2]", 12); }); // Red
-        t1.join();
-        t2.join();
+// Settings of the commands that read stored samples instead of monitoring
+struct AnalysisOptions {
+    int days = 1;           // the last N days
+    int stepSeconds = 60;   // grid spacing
+    JoinMethod method = kJoinLinear;
+    int maxLagMinutes = 30; // lead/lag searched up to this far either way
+};
 
-        // Now print results for each game, clearly separated
-        setColor(11);
-        std::cout << "\n\n=== GAME 1 RESULTS ===\n";
-        resetColor();
-        monitor1.showResults(info1.name);
+// Reads the stored CCU of every game and aligns it to one time grid over
+// the last options.days days. Samples from just before the range are read
+// too, so the first grid points can be filled.
+AlignedTable loadAligned(const std::vector<std::string>& ids, const AnalysisOptions& options) {
+    const int64_t kLeadMs = 60LL * 60 * 1000;
+    SampleStore store;
+    int64_t toMs = nowEpochMs();
+    int64_t fromMs = toMs - (int64_t)options.days * kRollupTiers[kRollup1Day].widthMs;
+    std::vector<SeriesColumns> series;
+    series.reserve(ids.size());
+    for (const auto& id : ids) series.push_back(SeriesColumns::ccuOf(store.readSeries(id, fromMs - kLeadMs)));
+    return alignSeries(series, TimeGrid::covering(fromMs, toMs, options.stepSeconds * 1000LL), options.method);
+}
 
-        setColor(11);
-        std::cout << "\n\n=== GAME 2 RESULTS ===\n";
-        resetColor();
-        monitor2.showResults(info2.name);
+// Writes the aligned CCU as CSV: a time column, then one column per game;
+// gaps (no stored sample near the grid time) are empty cells
+int exportAligned(const std::vector<std::string>& ids, const std::string& path, const AnalysisOptions& options) {
+    auto started = std::chrono::steady_clock::now();
+    AlignedTable table = loadAligned(ids, options);
 
-        // Comparison summary
-        setColor(10);
-        std::cout << "\n\n=== COMPARISON SUMMARY ===\n";
-        std::cout << std::string(60, '=') << std::endl;
-        resetColor();
-        std::cout << "Game 1: " << info1.name << "\nGame 2: " << info2.name << std::endl;
-        std::cout << "Monitoring Duration: " << minutes << " minutes" << std::endl;
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        std::cerr << "Cannot write " << path << std::endl;
+        return 1;
+    }
+    std::fputs("time", file);
+    for (const auto& id : ids) std::fprintf(file, ",%s", id.c_str());
+    std::fputc('\n', file);
+    const char* format = options.method == kJoinAsOf ? ",%.0f" : ",%.1f";
+    size_t gaps = 0;
+    for (size_t i = 0; i < table.grid.size; i++) {
+        std::fputs(formatTimestamp(table.grid.at(i)).c_str(), file);
+        for (const auto& column : table.columns) {
+            if (AlignedTable::isGap(column[i])) {
+                std::fputc(',', file);
+                gaps++;
+            } else {
+                std::fprintf(file, format, column[i]);
+            }
+        }
+        std::fputc('\n', file);
+    }
+    if (std::fclose(file) != 0) {
+        std::cerr << "Cannot write " << path << std::endl;
+        return 1;
+    }
 
-        std::cout << "\nCCU Averages:\n";
-        std::cout << info1.name << ": " << std::fixed << std::setprecision(2) << monitor1.getAverageCCU() << std::endl;
-        std::cout << info2.name << ": " << std::fixed << std::setprecision(2) << monitor2.getAverageCCU() << std::endl;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::cout << "Exported " << ids.size() << " game" << (ids.size() == 1 ? "" : "s") << " x " << table.grid.size
+              << " points (every " << options.stepSeconds << " s, " << gaps << " gaps) to " << path
+              << " in " << std::fixed << std::setprecision(2) << seconds << " s" << std::endl;
+    return 0;
+}
 
-        size_t peak1 = monitor1.getPeakCCUIndex();
-        size_t peak2 = monitor2.getPeakCCUIndex();
-        size_t low1 = monitor1.getLowestCCUIndex();
-        size_t low2 = monitor2.getLowestCCUIndex();
+// "5 min" or "90 s"
+std::string formatLag(int64_t seconds) {
+    if (seconds % 60 == 0) return std::to_string(seconds / 60) + " min";
+    return std::to_string(seconds) + " s";
+}
 
-        const auto& dp1 = monitor1.getDataPoints();
-        const auto& dp2 = monitor2.getDataPoints();
+// Correlates the CCU changes of every pair of games over the stored
+// history and prints the pairs that move together, the ones that move
+// opposite and the ones where one game leads; pairsPath (if given) gets
+// every pair as CSV
+int correlateStored(const std::vector<std::string>& ids, const std::string& pairsPath, const AnalysisOptions& options) {
+    if (ids.size() < 2) {
+        std::cerr << "Correlation needs at least two Universe IDs." << std::endl;
+        return 1;
+    }
+    auto started = std::chrono::steady_clock::now();
+    AlignedTable table = loadAligned(ids, options);
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t maxLagSteps = (size_t)options.maxLagMinutes * 60 / options.stepSeconds;
+    maxLagSteps = std::min(maxLagSteps, table.grid.size > 2 ? table.grid.size - 2 : 0); // as correlateDeltas does
+    CorrelationMatrix matrix = correlateDeltas(table, maxLagSteps, threads);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    // Names from the game info cache where known, without fetching anything
+    GameInfoCache cache;
+    std::vector<std::string> names;
+    for (const auto& id : ids) {
+        GameInfo info;
+        names.push_back(cache.lookup(id, info) == GameInfoCache::kValid ? info.name + " (" + id + ")" : id);
+    }
 
-        std::cout << "\nPeak CCU:\n";
-        if (!dp1.empty())
-            std::cout << info1.name << ": " << dp1[peak1].ccu << " (Minute " << (peak1+1) << ", " << dp1[peak1].timestamp << ")" << std::endl;
-        else
-            std::cout << info1.name << ": N/A" << std::endl;
-        if (!dp2.empty())
-            std::cout << info2.name << ": " << dp2[peak2].ccu << " (Minute " << (peak2+1) << ", " << dp2[peak2].timestamp << ")" << std::endl;
-        else
-            std::cout << info2.name << ": N/A" << std::endl;
+    struct RankedPair {
+        size_t a, b;
+        PairCorrelation pair;
+    };
+    std::vector<RankedPair> scored, leads;
+    for (size_t a = 0; a < ids.size(); a++) {
+        for (size_t b = a + 1; b < ids.size(); b++) {
+            PairCorrelation pair = matrix.at(a, b);
+            if (!pair.scored()) continue;
+            scored.push_back({a, b, pair});
+            // Listed as leader first
+            if (pair.hasLead()) leads.push_back(pair.lagSteps > 0 ? RankedPair{a, b, pair} : RankedPair{b, a, matrix.at(b, a)});
+        }
+    }
 
-        std::cout << "\nLowest CCU:\n";
-        if (!dp1.empty())
-            std::cout << info1.name << ": " << dp1[low1].ccu << " (Minute " << (low1+1) << ", " << dp1[low1].timestamp << ")" << std::endl;
-        else
-            std::cout << info1.name << ": N/A" << std::endl;
-        if (!dp2.empty())
-            std::cout << info2.name << ": " << dp2[low2].ccu << " (Minute " << (low2+1) << ", " << dp2[low2].timestamp << ")" << std::endl;
-        else
-            std::cout << info2.name << ": N/A" << std::endl;
+    setColor(10);
+    std::cout << "\n=== CORRELATION OF CCU CHANGES ===\n";
+    std::cout << std::string(60, '=') << std::endl;
+    resetColor();
+    std::cout << "Games: " << ids.size() << " (" << scored.size() << " of " << matrix.pairCount()
+              << " pairs with enough common data)" << std::endl;
+    std::cout << "Range: last " << options.days << " day" << (options.days == 1 ? "" : "s") << ", every "
+              << options.stepSeconds << " s (" << table.grid.size << " points), leads up to "
+              << formatLag((int64_t)maxLagSteps * options.stepSeconds) << std::endl;
+    std::cout << "Computed in " << std::fixed << std::setprecision(2) << seconds << " s on " << threads
+              << " thread" << (threads == 1 ? "" : "s") << std::endl;
+
+    auto printRanked = [&](const char* title, std::vector<RankedPair>& list, auto better, bool lead) {
+        size_t shown = std::min(list.size(), kRankedGamesShown);
+        std::partial_sort(list.begin(), list.begin() + shown, list.end(), better);
+        std::cout << "\n" << title;
+        if (shown < list.size()) std::cout << " (top " << shown << " of " << list.size() << ")";
+        std::cout << ":\n";
+        if (shown == 0) std::cout << "none" << std::endl;
+        std::cout << std::fixed << std::setprecision(2);
+        for (size_t r = 0; r < shown; r++) {
+            const RankedPair& ranked = list[r];
+            if (lead) {
+                std::cout << (r + 1) << ". " << names[ranked.a] << " leads " << names[ranked.b] << " by "
+                          << formatLag((int64_t)ranked.pair.lagSteps * options.stepSeconds) << ": r "
+                          << ranked.pair.lagged << " (" << ranked.pair.correlation << " at the same time)" << std::endl;
+            } else {
+                std::cout << (r + 1) << ". " << names[ranked.a] << " / " << names[ranked.b] << ": r "
+                          << ranked.pair.correlation << " (" << ranked.pair.points << " points)" << std::endl;
+            }
+        }
+    };
+    std::vector<RankedPair> opposite;
+    for (const auto& ranked : scored) if (ranked.pair.correlation < 0) opposite.push_back(ranked);
+    printRanked("Moving Together", scored, [](const RankedPair& x, const RankedPair& y) {
+        return x.pair.correlation > y.pair.correlation;
+    }, false);
+    printRanked("Moving Opposite", opposite, [](const RankedPair& x, const RankedPair& y) {
+        return x.pair.correlation < y.pair.correlation;
+    }, false);
+    printRanked("Leading", leads, [](const RankedPair& x, const RankedPair& y) {
+        return std::fabs(x.pair.lagged) > std::fabs(y.pair.lagged);
+    }, true);
+
+    setColor(10);
+    std::cout << std::string(60, '=') << std::endl;
+    resetColor();
 
-        setColor(10);
-        std::cout << std::string(60, '=') << std::endl;
-        resetColor();
-        system("pause");
-        return 0;
+    if (pairsPath.empty()) return 0;
+    FILE* file = std::fopen(pairsPath.c_str(), "w");
+    if (!file) {
+        std::cerr << "Cannot write " << pairsPath << std::endl;
+        return 1;
+    }
+    // lead_seconds > 0: game_a moves first
+    std::fputs("game_a,game_b,correlation,lead_seconds,lagged_correlation,points\n", file);
+    for (size_t a = 0; a < ids.size(); a++) {
+        for (size_t b = a + 1; b < ids.size(); b++) {
+            PairCorrelation pair = matrix.at(a, b);
+            std::fprintf(file, "%s,%s,", ids[a].c_str(), ids[b].c_str());
+            if (pair.scored())
+                std::fprintf(file, "%.4f,%lld,%.4f,%u\n", pair.correlation,
+                             (long long)pair.lagSteps * options.stepSeconds, pair.lagged, pair.points);
+            else
+                std::fprintf(file, ",,,%u\n", pair.points);
+        }
+    }
+    if (std::fclose(file) != 0) {
+        std::cerr << "Cannot write " << pairsPath << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << matrix.pairCount() << " pairs to " << pairsPath << std::endl;
+    return 0;
+}
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options] [universeId ...]\n"
+              << "  -f, --watchlist FILE  read universe IDs from FILE (separated by spaces, commas or\n"
+              << "                        newlines, # starts a comment)\n"
+              << "  -m, --minutes N       monitor for N minutes (0 = run until stopped)\n"
+              << "  -u, --updates N       record N CCU updates instead of minutes (0 = run until stopped)\n"
+              << "  -r, --resume          continue the session that was interrupted (crash, closed window)\n"
+              << "  -x, --export FILE     write the stored CCU of the given games to FILE as CSV, aligned\n"
+              << "                        to one time grid (no monitoring)\n"
+              << "  -c, --correlate       correlate the CCU changes of every pair of the given games over\n"
+              << "                        their stored history and show which move together or lead\n"
+              << "      --pairs FILE      with --correlate, also write every pair to FILE as CSV\n"
+              << "      --max-lag MINUTES how far --correlate looks for leads (default 30)\n"
+              << "      --days N          stored history used by --export and --correlate: the last N days\n"
+              << "                        (default 1)\n"
+              << "      --step SECONDS    time grid spacing for --export and --correlate (default 60)\n"
+              << "      --asof            take the latest sample at each grid time instead of interpolating\n"
+              << "  -h, --help            show this help\n"
+              << "Without arguments everything is asked interactively." << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+
+    initConsole();
+    MonitorEngine::installStopHandler();
+
+    // Command line: universe IDs and/or watchlist files, optional duration
+    Watchlist watchlist;
+    int duration = -1; // -1 = ask
+    bool countUpdates = false;
+    bool resumeRequested = false;
+    std::string exportPath;
+    bool correlate = false;
+    std::string pairsPath;
+    AnalysisOptions analysis;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (arg == "-r" || arg == "--resume") {
+            resumeRequested = true;
+            continue;
+        }
+        if (arg == "-c" || arg == "--correlate") {
+            correlate = true;
+            continue;
+        }
+        if (arg == "--asof") {
+            analysis.method = kJoinAsOf;
+            continue;
+        }
+        if (arg == "-f" || arg == "--watchlist" || arg == "-m" || arg == "--minutes" ||
+            arg == "-u" || arg == "--updates" || arg == "-x" || arg == "--export" ||
+            arg == "--pairs" || arg == "--days" || arg == "--step" || arg == "--max-lag") {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return 1;
+            }
+            std::string value = argv[++i];
+            if (arg == "-f" || arg == "--watchlist") {
+                if (!watchlist.loadFile(value)) {
+                    std::cerr << "Cannot read watchlist file: " << value << std::endl;
+                    return 1;
+                }
+                continue;
+            }
+            if (arg == "-x" || arg == "--export") {
+                exportPath = value;
+                continue;
+            }
+            if (arg == "--pairs") {
+                pairsPath = value;
+                continue;
+            }
+            if (arg == "--days" || arg == "--step" || arg == "--max-lag") {
+                int number = 0;
+                try {
+                    size_t used = 0;
+                    number = std::stoi(value, &used);
+                    if (used != value.size() || number <= 0) throw std::invalid_argument(value);
+                } catch (...) {
+                    std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+                    return 1;
+                }
+                (arg == "--days" ? analysis.days : arg == "--step" ? analysis.stepSeconds : analysis.maxLagMinutes) = number;
+                continue;
+            }
+            try {
+                size_t used = 0;
+                duration = std::stoi(value, &used);
+                if (used != value.size() || duration < 0) throw std::invalid_argument(value);
+            } catch (...) {
+                std::cerr << "Invalid duration: " << value << std::endl;
+                return 1;
+            }
+            countUpdates = (arg == "-u" || arg == "--updates");
+            continue;
+        }
+        watchlist.add(arg);
+    }
+    for (const auto& token : watchlist.rejected())
+        std::cerr << "Ignoring invalid Universe ID: " << token << std::endl;
+    if (argc > 1 && watchlist.empty() && !resumeRequested) {
+        std::cerr << "No Universe IDs given." << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+    bool fromCommandLine = !watchlist.empty();
+    if (!exportPath.empty()) {
+        int result = exportAligned(watchlist.ids(), exportPath, analysis);
+        if (result != 0 || !correlate) return result;
+    }
+    if (correlate) return correlateStored(watchlist.ids(), pairsPath, analysis);
+
+    setColor(11); // Cyan
+    std::cout << "Roblox Game Monitoring Tool" << std::endl;
+    std::cout << std::string(40, '=') << std::endl;
+    resetColor();
+
+    // An interrupted session is resumed on request, or offered when nothing
+    // was given on the command line; starting a new session replaces it
+    {
+        SessionJournal journal;
+        SessionJournal::Recovered recovered;
+        bool resume = false;
+        if (resumeRequested) {
+            if (!journal.recover(recovered)) {
+                std::cerr << "No interrupted session to resume in " << SampleStore::defaultDirectory() << std::endl;
+                return 1;
+            }
+            resume = true;
+        } else if (!fromCommandLine && journal.hasUnfinished() && journal.recover(recovered)) {
+            std::string resumeInput;
+            std::cout << "An interrupted session of " << recovered.config.ids.size() << " game"
+                      << (recovered.config.ids.size() == 1 ? "" : "s") << " from "
+                      << formatTimestamp(recovered.config.startedMs) << " was found. Resume it? (y/n): ";
+            std::getline(std::cin, resumeInput);
+            resume = (resumeInput.size() > 0 && (resumeInput[0] == 'y' || resumeInput[0] == 'Y'));
+        }
+        if (resume) {
+            int result = resumeSession(recovered);
+            pauseConsole();
+            return result;
+        }
+    }
+
+    bool compareMode = fromCommandLine;
+    if (!fromCommandLine) {
+        std::string compareModeInput;
+        std::cout << "Initiate compare mode? (y/n): ";
+        std::getline(std::cin, compareModeInput);
+
+        compareMode = (compareModeInput.size() > 0 && (compareModeInput[0] == 'y' || compareModeInput[0] == 'Y'));
+
+        std::string updateModeInput;
+        std::cout << "Count CCU updates instead of minutes? (y/n): ";
+        std::getline(std::cin, updateModeInput);
+
+        countUpdates = (updateModeInput.size() > 0 && (updateModeInput[0] == 'y' || updateModeInput[0] == 'Y'));
+    }
+
+    // Returns false (after printing why) if the input is not a valid duration
+    auto promptDuration = [&]() {
+        std::cout << (countUpdates
+            ? "Enter number of CCU updates to record (0 = run until stopped): "
+            : "Enter monitoring duration (minutes, 0 = run until stopped): ");
+        if (!(std::cin >> duration)) {
+            setColor(12);
+            std::cout << "Invalid input. Please enter a number." << std::endl;
+            resetColor();
+            return false;
+        }
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+
+        if (duration < 0) {
+            setColor(12);
+            std::cout << "Invalid duration. Please enter a positive number or 0." << std::endl;
+            resetColor();
+            return false;
+        }
+        return true;
+    };
+
+    if (compareMode) {
+        std::vector<std::string> validIds;
+        std::vector<GameInfo> validInfos;
+
+        // Prompt for the watchlist until at least one Universe ID is valid
+        while (validIds.empty()) {
+            if (!fromCommandLine) {
+                std::string input;
+                do {
+                    std::cout << "Enter Roblox Universe IDs (separated by spaces or commas) or a watchlist file: ";
+                    std::getline(std::cin, input);
+                } while (input.empty());
+                watchlist = Watchlist();
+                if (!watchlist.loadFile(input)) watchlist.add(input);
+                for (const auto& token : watchlist.rejected()) {
+                    setColor(12);
+                    std::cout << "Invalid Universe ID: " << token << std::endl;
+                    resetColor();
+                }
+            }
+
+            std::vector<std::string> invalidIds;
+            validateUniverses(watchlist.ids(), validIds, validInfos, invalidIds);
+            reportInvalidIds(invalidIds);
+            if (validIds.empty() && fromCommandLine) {
+                std::cerr << "None of the given Universe IDs are valid." << std::endl;
+                pauseConsole();
+                return 1;
+            }
+            if (validIds.empty()) std::cout << "Please try again.\n";
+        }
+
+        if (duration < 0 && !promptDuration()) {
+            pauseConsole();
+            return 1;
+        }
+        std::cout << std::endl;
+        if (duration == 0) std::cout << "Running until stopped. Press Ctrl+C to stop and show results.\n\n";
+
+        int result = runWatchlist(validIds, validInfos, duration, countUpdates);
+        pauseConsole();
+        return result;
     } else {
         std::string gameId;
-        int minutes;
+        GameInfo validInfo;
 
         // Prompt for Universe ID and validate
         while (true) {
@@ -498,52 +1242,28 @@ int main() {
                 std::cout << "Enter Roblox Universe ID: ";
                 std::getline(std::cin, gameId);
             } while (gameId.empty());
-            RobloxGameMonitor monitorTest(gameId, 1);
-            auto infoTest = monitorTest.fetchGameInfo();
-            if (isGameInfoValid(infoTest)) break;
+            std::vector<std::string> validIds, invalidIds;
+            std::vector<GameInfo> validInfos;
+            validateUniverses({gameId}, validIds, validInfos, invalidIds);
+            if (!validInfos.empty()) {
+                validInfo = validInfos[0];
+                break;
+            }
             setColor(12);
             std::cout << "Invalid Universe ID (N/A returned). Please try again.\n";
             resetColor();
         }
 
-        std::cout << "Enter monitoring duration (minutes): ";
-        if (!(std::cin >> minutes)) {
-            setColor(12);
-            std::cout << "Invalid input. Please enter a number." << std::endl;
-            resetColor();
-            system("pause");
-            return 1;
-        }
-        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-
-        if (minutes <= 0) {
-            setColor(12);
-            std::cout << "Invalid duration. Please enter a positive number." << std::endl;
-            resetColor();
-            system("pause");
+        if (!promptDuration()) {
+            pauseConsole();
             return 1;
         }
 
         std::cout << std::endl;
+        if (duration == 0) std::cout << "Running until stopped. Press Ctrl+C to stop and show results.\n\n";
 
-        RobloxGameMonitor monitor(gameId, minutes);
-        auto info = monitor.fetchGameInfo();
-        monitor.printGameInfoTable(info);
-        monitor.setSkipInfoPrint(true);
-        monitor.startMonitoring(); // No prefix, default color (cyan)
-        // Print logs after monitoring
-        const auto& logs = monitor.getLogLines();
-        for (const auto& line : logs) {
-            setColor(11);
-            std::cout << line << std::endl;
-            resetColor();
-        }
-        monitor.showResults(info.name);
-
-        setColor(10);
-        std::cout << "\nMonitoring completed successfully!" << std::endl;
-        resetColor();
-        system("pause");
-        return 0;
+        int result = runSingleGame(gameId, validInfo, duration, countUpdates);
+        pauseConsole();
+        return result;
     }
-}
\ No newline at end of file
+}
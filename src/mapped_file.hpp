@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only memory map of a whole file (MapViewOfFile on Windows, mmap
+// elsewhere). The file handles are closed right after mapping; the view
+// stays valid until unmap(). Missing or empty files map to nothing.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { unmap(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool map(const std::string& path) {
+        unmap();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0) {
+            CloseHandle(file);
+            return false;
+        }
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        CloseHandle(file);
+        if (!mapping) return false;
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (!view) return false;
+        bytes = static_cast<const char*>(view);
+        length = (size_t)fileSize.QuadPart;
+#else
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+            close(fd);
+            return false;
+        }
+        void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (view == MAP_FAILED) return false;
+        bytes = static_cast<const char*>(view);
+        length = (size_t)info.st_size;
+#endif
+        return true;
+    }
+
+    void unmap() {
+        if (!bytes) return;
+#ifdef _WIN32
+        UnmapViewOfFile(bytes);
+#else
+        munmap(const_cast<char*>(bytes), length);
+#endif
+        bytes = nullptr;
+        length = 0;
+    }
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+};
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "game_data.hpp"
+#include "batch_fetcher.hpp"
+#include "timing_wheel.hpp"
+#include "refresh_estimator.hpp"
+
+// Single-threaded engine that drives every monitored universe.
+// Timers live in a hierarchical timing wheel on one thread; each sampling
+// tick sends the games and votes requests for the whole watchlist
+// concurrently and hands each universe its snapshot. Replaces one sleeping
+// thread per game.
+//
+// The first sample is taken immediately. Later ticks land on wall-clock
+// multiples of the interval (e.g. every :00 for one minute), computed from
+// absolute deadlines, so fetch latency never accumulates and series from
+// different games and runs line up exactly.
+//
+// runOnChange() instead gives every universe its own timer: each one is
+// polled just after its learned upstream cache refresh, and its handler
+// only sees samples whose CCU actually changed.
+class MonitorEngine {
+public:
+    using Clock = std::chrono::steady_clock;
+    // Called with each new snapshot; returns false once the universe is done
+    using SampleHandler = std::function<bool(const GameSnapshot&)>;
+
+    // Metadata (name, description, creator) is copied out of the games
+    // response on the first tick and then once per this many ticks
+    static constexpr unsigned kMetadataRefreshTicks = 60;
+
+    // Slack after a predicted refresh before polling, and how long due
+    // universes wait for others to join the same batched request
+    static constexpr std::chrono::milliseconds kRefreshMargin{1000};
+    static constexpr std::chrono::milliseconds kCoalesceWindow{250};
+
+    // lastCcu is the CCU already recorded for the universe (-1 if none), so
+    // a resumed runOnChange() does not take an unchanged value as new
+    void watch(const std::string& universeId, SampleHandler handler, int64_t lastCcu = -1) {
+        Universe u;
+        u.id = universeId;
+        u.handler = std::move(handler);
+        u.hasLast = lastCcu >= 0;
+        u.lastCcu = u.hasLast ? (uint32_t)lastCcu : 0;
+        universes.push_back(std::move(u));
+    }
+
+    // Called after every tick (or batched poll) once all handlers have run
+    void setTickCallback(std::function<void()> fn) { afterTick = std::move(fn); }
+
+    // Runs fn at the given absolute deadline
+    void schedule(Clock::time_point deadline, std::function<void()> fn) {
+        timers.schedule(deadline, std::move(fn));
+    }
+
+    // Samples every interval until all handlers are done or a stop is
+    // requested. A resumed run passes the wall time its next tick was due
+    // (firstTickMs) and keeps that schedule: it waits for that tick, or the
+    // next boundary if it has passed, instead of sampling immediately.
+    void run(std::chrono::milliseconds interval, int64_t firstTickMs = 0) {
+        nextBoundaryMs = 0;
+        int64_t wallNowMs = nowEpochMs();
+        if (firstTickMs == 0) {
+            scheduleTick(Clock::now(), wallNowMs, interval);
+        } else if (firstTickMs > wallNowMs) {
+            nextBoundaryMs = firstTickMs;
+            scheduleTick(Clock::now() + std::chrono::milliseconds(firstTickMs - wallNowMs), firstTickMs, interval);
+        } else {
+            auto deadline = nextAlignedDeadline(interval);
+            scheduleTick(deadline, nextBoundaryMs, interval);
+        }
+        loop();
+    }
+
+    // Samples each universe only when its CCU changes upstream. Universes
+    // whose refresh period is not learned yet are probed every probeInterval
+    // (backing off while nothing changes); the rest are polled once per
+    // refresh, so requests that would return cached values are skipped.
+    void runOnChange(std::chrono::milliseconds probeInterval) {
+        probeMs = probeInterval.count();
+        auto now = Clock::now();
+        for (size_t i = 0; i < universes.size(); i++) schedulePoll(i, now);
+        loop();
+    }
+
+    // Wall time of the next scheduled tick while run() is going, else 0
+    int64_t nextTickMs() const { return nextBoundaryMs; }
+
+    // Next wall-clock multiple of interval after the last scheduled one,
+    // skipping boundaries that have already passed, as a steady deadline
+    Clock::time_point nextAlignedDeadline(std::chrono::milliseconds interval) {
+        int64_t wallNowMs = nowEpochMs();
+        auto steadyNow = Clock::now();
+        int64_t step = interval.count();
+        if (nextBoundaryMs == 0) nextBoundaryMs = (wallNowMs / step) * step;
+        nextBoundaryMs += step;
+        if (nextBoundaryMs <= wallNowMs) nextBoundaryMs = (wallNowMs / step + 1) * step;
+        return steadyNow + std::chrono::milliseconds(nextBoundaryMs - wallNowMs);
+    }
+
+    // Safe to call from a signal handler
+    static void requestStop() { stopFlag() = true; }
+    static bool stopRequested() { return stopFlag(); }
+
+    // Ctrl+C ends the run at the next tick boundary instead of killing the
+    // process, so results are still printed (needed for run-forever mode)
+    static void installStopHandler() {
+        stopFlag();
+        std::signal(SIGINT, [](int) { requestStop(); });
+    }
+
+    size_t activeCount() const {
+        size_t count = 0;
+        for (const auto& u : universes) if (u.active) count++;
+        return count;
+    }
+
+private:
+    static constexpr std::chrono::milliseconds kStopPollInterval{200};
+
+    static std::atomic<bool>& stopFlag() {
+        static std::atomic<bool> flag{false};
+        return flag;
+    }
+
+    struct Universe {
+        std::string id;
+        SampleHandler handler;
+        bool active = true;
+        // Sample-on-change state
+        RefreshEstimator estimator;
+        bool hasLast = false;
+        uint32_t lastCcu = 0;
+    };
+
+    std::vector<Universe> universes;
+    TimingWheel timers;
+    int64_t nextBoundaryMs = 0; // wall-clock epoch ms of the last aligned tick
+    unsigned tickCount = 0;
+    BatchFetcher fetcher;
+    int64_t probeMs = 0;
+    std::vector<size_t> due; // universes whose poll timer fired, waiting for the batch
+    bool flushPending = false;
+    std::function<void()> afterTick;
+
+    void loop() {
+        while (!timers.empty() && !stopFlag()) {
+            auto now = Clock::now();
+            auto wakeup = timers.nextWakeup();
+            if (now < wakeup) {
+                // Sleep in short slices so a stop request is noticed quickly
+                std::this_thread::sleep_until(std::min(wakeup, now + kStopPollInterval));
+                continue;
+            }
+            timers.advance(now);
+        }
+    }
+
+    void scheduleTick(Clock::time_point deadline, int64_t wallTimeMs, std::chrono::milliseconds interval) {
+        schedule(deadline, [this, wallTimeMs, interval]() {
+            tick(wallTimeMs);
+            // The next deadline is known before afterTick runs, so it can be journaled
+            bool more = activeCount() > 0;
+            Clock::time_point next;
+            if (more) next = nextAlignedDeadline(interval);
+            else nextBoundaryMs = 0;
+            if (afterTick) afterTick();
+            if (more) scheduleTick(next, nextBoundaryMs, interval);
+        });
+    }
+
+    // Samples are stamped with the tick's scheduled wall time, so every game
+    // sampled on the same tick carries the same timestamp. A universe
+    // missing from the results still gets its tick, as a failed snapshot,
+    // so handlers can count the missed sample without recording it.
+    void tick(int64_t timestampMs) {
+        std::vector<std::string> ids;
+        for (const auto& u : universes) if (u.active) ids.push_back(u.id);
+        auto results = fetcher.fetch(ids, tickCount++ % kMetadataRefreshTicks == 0);
+
+        for (auto& u : universes) {
+            if (!u.active) continue;
+            auto it = results.find(u.id);
+            if (it != results.end()) {
+                it->second.data.timestampMs = timestampMs;
+                u.active = u.handler(it->second);
+            } else {
+                u.active = u.handler(GameSnapshot::failedAt(timestampMs));
+            }
+        }
+    }
+
+    void schedulePoll(size_t index, Clock::time_point deadline) {
+        schedule(deadline, [this, index]() {
+            due.push_back(index);
+            if (!flushPending) {
+                flushPending = true;
+                schedule(Clock::now() + kCoalesceWindow, [this]() { flushDue(); });
+            }
+        });
+    }
+
+    // One batched request for every due universe; only changed CCU values
+    // reach the handlers (a failed poll changes nothing, the universe is
+    // polled again on its schedule)
+    void flushDue() {
+        flushPending = false;
+        std::vector<size_t> batch;
+        batch.swap(due);
+        std::vector<std::string> ids;
+        for (size_t index : batch) ids.push_back(universes[index].id);
+        auto results = fetcher.fetch(ids, tickCount++ % kMetadataRefreshTicks == 0);
+
+        int64_t pollMs = nowEpochMs();
+        for (size_t index : batch) {
+            Universe& u = universes[index];
+            auto it = results.find(u.id);
+            if (it != results.end() && !it->second.failed) {
+                const GameSnapshot& snapshot = it->second;
+                bool changed = !u.hasLast || snapshot.data.ccu != u.lastCcu;
+                // The first response only establishes the baseline for the estimator
+                u.estimator.observe(pollMs, changed && u.hasLast);
+                if (changed) {
+                    u.hasLast = true;
+                    u.lastCcu = snapshot.data.ccu;
+                    GameSnapshot sample = snapshot;
+                    sample.data.timestampMs = pollMs;
+                    u.active = u.handler(sample);
+                }
+            }
+            if (!u.active) continue;
+
+            int64_t wallNowMs = nowEpochMs();
+            int64_t nextMs = u.estimator.nextPollMs(wallNowMs, probeMs, kRefreshMargin.count());
+            schedulePoll(index, Clock::now() + std::chrono::milliseconds(nextMs - wallNowMs));
+        }
+        if (afterTick) afterTick();
+    }
+};
@@ -0,0 +1,708 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include "http_transport.hpp"
+
+// Readiness poller over non-blocking sockets: epoll on Linux, poll() elsewhere.
+class SocketPoller {
+public:
+    enum { kRead = 1, kWrite = 2 };
+
+    SocketPoller() {
+#ifdef __linux__
+        epfd = epoll_create1(EPOLL_CLOEXEC);
+#endif
+    }
+
+    ~SocketPoller() {
+#ifdef __linux__
+        if (epfd >= 0) close(epfd);
+#endif
+    }
+
+    SocketPoller(const SocketPoller&) = delete;
+    SocketPoller& operator=(const SocketPoller&) = delete;
+
+    // Adds fd or changes its interest set
+    void set(int fd, int events, void* tag) {
+#ifdef __linux__
+        epoll_event ev = {};
+        ev.events = ((events & kRead) ? (uint32_t)EPOLLIN : 0u) | ((events & kWrite) ? (uint32_t)EPOLLOUT : 0u);
+        ev.data.ptr = tag;
+        bool known = registered.count(fd) > 0;
+        epoll_ctl(epfd, known ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &ev);
+        registered[fd] = tag;
+#else
+        registered[fd] = {events, tag};
+#endif
+    }
+
+    void remove(int fd) {
+        if (!registered.erase(fd)) return;
+#ifdef __linux__
+        epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+#endif
+    }
+
+    // Waits up to timeoutMs and fills ready with the tags of ready sockets
+    void wait(int timeoutMs, std::vector<void*>& ready) {
+        ready.clear();
+#ifdef __linux__
+        epoll_event events[64];
+        int n = epoll_wait(epfd, events, 64, timeoutMs);
+        for (int i = 0; i < n; i++) ready.push_back(events[i].data.ptr);
+#else
+        std::vector<pollfd> fds;
+        std::vector<void*> tags;
+        for (const auto& entry : registered) {
+            pollfd p = {entry.first, 0, 0};
+            if (entry.second.first & kRead) p.events |= POLLIN;
+            if (entry.second.first & kWrite) p.events |= POLLOUT;
+            fds.push_back(p);
+            tags.push_back(entry.second.second);
+        }
+        if (poll(fds.data(), fds.size(), timeoutMs) <= 0) return;
+        for (size_t i = 0; i < fds.size(); i++)
+            if (fds[i].revents) ready.push_back(tags[i]);
+#endif
+    }
+
+private:
+#ifdef __linux__
+    int epfd = -1;
+    std::unordered_map<int, void*> registered;
+#else
+    std::unordered_map<int, std::pair<int, void*>> registered;
+#endif
+};
+
+// POSIX sockets + OpenSSL backend.
+// Keeps idle keep-alive connections per scheme/host/port and drives every
+// request of a getMany call as a non-blocking state machine on one poller,
+// so all requests of a tick are in flight at once on the calling thread.
+// Each connection keeps its read buffer between requests.
+//
+// getaddrinfo blocks, so host names are resolved before any request of a
+// getMany call is started (hosts new to the call in parallel) and cached
+// for kResolveTtl. A connect tries the addresses in order, starting with
+// the one that last worked, so one unreachable record (often IPv6 on an
+// IPv4-only machine) does not fail the host.
+class PosixTransport : public HttpTransport {
+public:
+    explicit PosixTransport(int timeoutMs = 10000, size_t maxConnsPerHost = 16)
+        : timeoutMs(timeoutMs), maxConnsPerHost(maxConnsPerHost) {
+        signal(SIGPIPE, SIG_IGN); // a peer closing a pooled socket must not kill the process
+        sslCtx = SSL_CTX_new(TLS_client_method());
+        if (sslCtx) {
+            SSL_CTX_set_default_verify_paths(sslCtx);
+            SSL_CTX_set_verify(sslCtx, SSL_VERIFY_PEER, nullptr);
+            SSL_CTX_set_mode(sslCtx, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+        } else {
+            std::cerr << "SSL_CTX_new failed" << std::endl;
+        }
+    }
+
+    ~PosixTransport() override {
+        for (auto& entry : idle)
+            for (auto& conn : entry.second) closeConnection(*conn);
+        if (sslCtx) SSL_CTX_free(sslCtx);
+    }
+
+    PosixTransport(const PosixTransport&) = delete;
+    PosixTransport& operator=(const PosixTransport&) = delete;
+
+    std::string get(const std::string& url) override {
+        return getMany({url})[0];
+    }
+
+    std::vector<std::string> getMany(const std::vector<std::string>& urls) override {
+        std::vector<std::string> results(urls.size());
+        std::vector<std::unique_ptr<Request>> requests;
+        std::deque<Request*> waiting;
+        for (size_t i = 0; i < urls.size(); i++) {
+            auto req = std::unique_ptr<Request>(new Request());
+            req->index = i;
+            req->rawUrl = urls[i];
+            if (!ParsedUrl::parse(urls[i], req->url)) {
+                std::cerr << "Malformed URL: " << urls[i] << std::endl;
+                continue;
+            }
+            req->key = (req->url.https ? "https://" : "http://") + req->url.host + ":" + std::to_string(req->url.port);
+            waiting.push_back(req.get());
+            requests.push_back(std::move(req));
+        }
+
+        std::vector<Request*> toResolve;
+        for (auto& req : requests) toResolve.push_back(req.get());
+        resolveAll(toResolve);
+
+        SocketPoller poller;
+        std::unordered_map<std::string, size_t> inFlightPerHost;
+        size_t inFlight = 0;
+        std::vector<void*> ready;
+
+        auto startWaiting = [&]() {
+            for (size_t n = waiting.size(); n > 0; n--) {
+                Request* req = waiting.front();
+                waiting.pop_front();
+                if (inFlightPerHost[req->key] >= maxConnsPerHost) {
+                    waiting.push_back(req);
+                    continue;
+                }
+                inFlightPerHost[req->key]++;
+                inFlight++;
+                start(*req, poller);
+            }
+        };
+        auto settle = [&](Request& req) {
+            if (req.state == State::Done) results[req.index] = std::move(req.body);
+            inFlightPerHost[req.key]--;
+            inFlight--;
+        };
+
+        startWaiting();
+        while (true) {
+            for (auto& req : requests) {
+                if (!req->settled && (req->state == State::Done || req->state == State::Failed)) {
+                    req->settled = true;
+                    settle(*req);
+                }
+            }
+            if (!waiting.empty()) startWaiting();
+            if (inFlight == 0 && waiting.empty()) break;
+
+            auto nearest = Clock::time_point::max();
+            for (auto& req : requests) {
+                if (!isActive(*req)) continue;
+                nearest = std::min(nearest, req->deadline);
+                if (req->state == State::Connecting) nearest = std::min(nearest, req->connectDeadline);
+            }
+            if (nearest == Clock::time_point::max()) continue; // everything settled synchronously
+
+            auto now = Clock::now();
+            int waitMs = (int)std::max<long long>(0, std::chrono::duration_cast<std::chrono::milliseconds>(nearest - now).count());
+            poller.wait(waitMs, ready);
+            for (void* tag : ready) advance(*static_cast<Request*>(tag), poller);
+
+            now = Clock::now();
+            for (auto& req : requests) {
+                if (req->state == State::Connecting && now >= req->connectDeadline && now < req->deadline) {
+                    std::cerr << "connect timed out for host: " << req->url.host << ", trying its next address" << std::endl;
+                    if (connectNext(*req, poller)) advance(*req, poller);
+                    else fail(*req, poller);
+                }
+                if (isActive(*req) && now >= req->deadline) {
+                    std::cerr << "Request timed out for URL: " << req->rawUrl << std::endl;
+                    fail(*req, poller);
+                }
+            }
+        }
+        return results;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::chrono::minutes kResolveTtl{5};
+    // A connect to one of several addresses may use 1/kConnectShare of the timeout
+    static constexpr int kConnectShare = 4;
+
+    struct Address {
+        sockaddr_storage addr;
+        socklen_t length;
+        int family, socktype, protocol;
+    };
+
+    struct ResolvedHost {
+        std::vector<Address> addresses;
+        size_t preferred = 0; // the one that last connected
+        Clock::time_point expires;
+    };
+
+    enum class State { Idle, Connecting, Handshake, Writing, Reading, Done, Failed };
+
+    struct Connection {
+        int fd = -1;
+        SSL* ssl = nullptr;
+        std::string readBuffer; // reused between requests on this connection
+        bool reused = false;
+    };
+
+    struct Request {
+        size_t index = 0;
+        std::string rawUrl;
+        ParsedUrl url;
+        std::string key;
+        std::unique_ptr<Connection> conn;
+        State state = State::Idle;
+        Clock::time_point deadline;
+        bool retried = false;
+        bool settled = false;
+
+        std::string out;
+        size_t outPos = 0;
+
+        // Response parsing
+        size_t headerEnd = 0;       // offset of body in conn->readBuffer, 0 while headers are incomplete
+        int status = 0;
+        long long contentLength = -1;
+        bool chunked = false;
+        bool keepAlive = true;
+        size_t chunkPos = 0;        // next unparsed chunk header offset
+        std::string body;
+
+        // Addresses of the host (copied from the cache) and how many of
+        // them this request has tried
+        std::vector<Address> addresses;
+        size_t firstAddress = 0;
+        size_t addressesTried = 0;
+        Clock::time_point connectDeadline;
+    };
+
+    int timeoutMs;
+    size_t maxConnsPerHost;
+    SSL_CTX* sslCtx = nullptr;
+    std::mutex idleMtx;
+    std::unordered_map<std::string, std::vector<std::unique_ptr<Connection>>> idle;
+    std::mutex resolvedMtx;
+    std::unordered_map<std::string, ResolvedHost> resolved; // by request key
+
+    static bool isActive(const Request& req) {
+        return req.state != State::Idle && req.state != State::Done && req.state != State::Failed;
+    }
+
+    std::unique_ptr<Connection> acquireIdle(const std::string& key) {
+        std::lock_guard<std::mutex> lock(idleMtx);
+        auto it = idle.find(key);
+        if (it == idle.end() || it->second.empty()) return nullptr;
+        auto conn = std::move(it->second.back());
+        it->second.pop_back();
+        conn->reused = true;
+        return conn;
+    }
+
+    void releaseIdle(const std::string& key, std::unique_ptr<Connection> conn) {
+        conn->readBuffer.clear(); // keeps capacity
+        std::lock_guard<std::mutex> lock(idleMtx);
+        idle[key].push_back(std::move(conn));
+    }
+
+    static void closeConnection(Connection& conn) {
+        if (conn.ssl) SSL_free(conn.ssl);
+        if (conn.fd >= 0) close(conn.fd);
+        conn.ssl = nullptr;
+        conn.fd = -1;
+    }
+
+    void start(Request& req, SocketPoller& poller) {
+        req.deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+        req.out = "GET " + req.url.path + " HTTP/1.1\r\n"
+                  "Host: " + req.url.host + (req.url.port == (req.url.https ? 443 : 80) ? "" : ":" + std::to_string(req.url.port)) + "\r\n"
+                  "User-Agent: RobloxMonitor\r\n"
+                  "Accept: application/json\r\n"
+                  "Connection: keep-alive\r\n\r\n";
+        req.outPos = 0;
+        req.headerEnd = 0;
+        req.status = 0;
+        req.contentLength = -1;
+        req.chunked = false;
+        req.keepAlive = true;
+        req.chunkPos = 0;
+        req.body.clear();
+
+        req.conn = acquireIdle(req.key);
+        if (req.conn) {
+            req.state = State::Writing;
+        } else if (!openConnection(req)) {
+            req.state = State::Failed;
+            return;
+        }
+        advance(req, poller);
+    }
+
+    static bool lookup(const ParsedUrl& url, std::vector<Address>& addresses) {
+        addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* addrs = nullptr;
+        std::string port = std::to_string(url.port);
+        if (getaddrinfo(url.host.c_str(), port.c_str(), &hints, &addrs) != 0 || !addrs) return false;
+        for (addrinfo* ai = addrs; ai; ai = ai->ai_next) {
+            if (ai->ai_addrlen > sizeof(sockaddr_storage)) continue;
+            Address address = {};
+            std::memcpy(&address.addr, ai->ai_addr, ai->ai_addrlen);
+            address.length = (socklen_t)ai->ai_addrlen;
+            address.family = ai->ai_family;
+            address.socktype = ai->ai_socktype;
+            address.protocol = ai->ai_protocol;
+            addresses.push_back(address);
+        }
+        freeaddrinfo(addrs);
+        return !addresses.empty();
+    }
+
+    // Gives every request the addresses of its host, looking up the hosts
+    // that are not cached (or expired) first, each on its own thread
+    void resolveAll(const std::vector<Request*>& requests) {
+        auto now = Clock::now();
+        std::vector<const ParsedUrl*> missing;
+        std::vector<std::string> missingKeys;
+        {
+            std::lock_guard<std::mutex> lock(resolvedMtx);
+            std::unordered_set<std::string> seen;
+            for (Request* req : requests) {
+                auto it = resolved.find(req->key);
+                if ((it == resolved.end() || it->second.expires <= now) && seen.insert(req->key).second) {
+                    missing.push_back(&req->url);
+                    missingKeys.push_back(req->key);
+                }
+            }
+        }
+        std::vector<std::vector<Address>> found(missing.size());
+        std::vector<char> ok(missing.size(), 0);
+        if (missing.size() == 1) {
+            ok[0] = lookup(*missing[0], found[0]);
+        } else {
+            std::vector<std::thread> workers;
+            for (size_t i = 0; i < missing.size(); i++)
+                workers.emplace_back([&, i]() { ok[i] = lookup(*missing[i], found[i]); });
+            for (auto& t : workers) t.join();
+        }
+
+        std::lock_guard<std::mutex> lock(resolvedMtx);
+        for (size_t i = 0; i < missing.size(); i++) {
+            if (!ok[i]) {
+                std::cerr << "getaddrinfo failed for host: " << missing[i]->host << std::endl;
+                resolved.erase(missingKeys[i]);
+                continue;
+            }
+            ResolvedHost& host = resolved[missingKeys[i]];
+            host.addresses = std::move(found[i]);
+            host.preferred = 0;
+            host.expires = now + kResolveTtl;
+        }
+        for (Request* req : requests) {
+            auto it = resolved.find(req->key);
+            if (it == resolved.end()) continue;
+            req->addresses = it->second.addresses;
+            req->firstAddress = it->second.preferred < req->addresses.size() ? it->second.preferred : 0;
+        }
+    }
+
+    // Remembers which address connected, or forgets a host none of whose
+    // addresses did, so it is looked up again next time
+    void rememberAddress(const Request& req, bool connected) {
+        std::lock_guard<std::mutex> lock(resolvedMtx);
+        auto it = resolved.find(req.key);
+        if (it == resolved.end()) return;
+        if (!connected) {
+            resolved.erase(it);
+            return;
+        }
+        size_t index = (req.firstAddress + req.addressesTried - 1) % req.addresses.size();
+        if (index < it->second.addresses.size()) it->second.preferred = index;
+    }
+
+    // Gives up on the address being connected to and starts on the next one
+    bool connectNext(Request& req, SocketPoller& poller) {
+        poller.remove(req.conn->fd);
+        closeConnection(*req.conn);
+        req.conn.reset();
+        return openConnection(req);
+    }
+
+    // Starts a non-blocking connect to the next address not tried yet
+    bool openConnection(Request& req) {
+        if (req.addresses.empty()) return false;
+        while (req.addressesTried < req.addresses.size()) {
+            const Address& address = req.addresses[(req.firstAddress + req.addressesTried) % req.addresses.size()];
+            req.addressesTried++;
+            int fd = socket(address.family, address.socktype, address.protocol);
+            if (fd < 0) continue;
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+            int rc = connect(fd, reinterpret_cast<const sockaddr*>(&address.addr), address.length);
+            if (rc != 0 && errno != EINPROGRESS) {
+                std::cerr << "connect failed for host: " << req.url.host << " Error: " << std::strerror(errno) << std::endl;
+                close(fd);
+                continue;
+            }
+            req.conn.reset(new Connection());
+            req.conn->fd = fd;
+            req.state = State::Connecting;
+            // An address that does not answer gets part of the timeout
+            // while others are left to try
+            bool last = req.addressesTried == req.addresses.size();
+            req.connectDeadline = last ? Clock::time_point::max()
+                                       : Clock::now() + std::chrono::milliseconds(timeoutMs / kConnectShare);
+            return true;
+        }
+        rememberAddress(req, false);
+        return false;
+    }
+
+    // Moves the request forward as far as the socket allows without blocking
+    void advance(Request& req, SocketPoller& poller) {
+        while (isActive(req)) {
+            int want = 0;
+            switch (req.state) {
+            case State::Connecting: {
+                pollfd p = {req.conn->fd, POLLOUT, 0};
+                if (poll(&p, 1, 0) <= 0) { want = SocketPoller::kWrite; break; }
+                int err = 0;
+                socklen_t len = sizeof(err);
+                getsockopt(req.conn->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+                if (err != 0) {
+                    std::cerr << "connect failed for host: " << req.url.host << " Error: " << std::strerror(err) << std::endl;
+                    if (!connectNext(req, poller)) return fail(req, poller);
+                    continue;
+                }
+                rememberAddress(req, true);
+                if (req.url.https) {
+                    if (!sslCtx) return fail(req, poller);
+                    req.conn->ssl = SSL_new(sslCtx);
+                    SSL_set_fd(req.conn->ssl, req.conn->fd);
+                    SSL_set_tlsext_host_name(req.conn->ssl, req.url.host.c_str());
+                    SSL_set1_host(req.conn->ssl, req.url.host.c_str());
+                    req.state = State::Handshake;
+                } else {
+                    req.state = State::Writing;
+                }
+                continue;
+            }
+            case State::Handshake: {
+                int rc = SSL_connect(req.conn->ssl);
+                if (rc == 1) { req.state = State::Writing; continue; }
+                want = sslWant(req.conn->ssl, rc);
+                if (!want) {
+                    std::cerr << "TLS handshake failed for host: " << req.url.host << std::endl;
+                    ERR_clear_error();
+                    return fail(req, poller);
+                }
+                break;
+            }
+            case State::Writing: {
+                long n = ioWrite(*req.conn, req.out.data() + req.outPos, req.out.size() - req.outPos, want);
+                if (n < 0) return retryOrFail(req, poller);
+                req.outPos += n;
+                if (req.outPos == req.out.size()) { req.state = State::Reading; continue; }
+                break;
+            }
+            case State::Reading: {
+                bool eof = false;
+                long n = ioRead(*req.conn, want, eof);
+                if (n < 0) return retryOrFail(req, poller);
+                bool complete = n > 0 && parseResponse(req);
+                if (eof) {
+                    // The last bytes and the close can come in one read
+                    req.keepAlive = false;
+                    if (complete) return finish(req, poller);
+                    // Complete only for close-delimited bodies; a short
+                    // Content-Length or chunked body fails right away
+                    if (req.headerEnd && req.contentLength < 0 && !req.chunked) {
+                        req.body.assign(req.conn->readBuffer, req.headerEnd, std::string::npos);
+                        return finish(req, poller);
+                    }
+                    return retryOrFail(req, poller);
+                }
+                if (complete) return finish(req, poller);
+                break;
+            }
+            default:
+                return;
+            }
+            poller.set(req.conn->fd, want, &req);
+            return;
+        }
+    }
+
+    static int sslWant(SSL* ssl, int rc) {
+        int err = SSL_get_error(ssl, rc);
+        if (err == SSL_ERROR_WANT_READ) return SocketPoller::kRead;
+        if (err == SSL_ERROR_WANT_WRITE) return SocketPoller::kWrite;
+        return 0;
+    }
+
+    // Returns bytes written, 0 with want set when blocked, -1 on error
+    static long ioWrite(Connection& conn, const char* data, size_t len, int& want) {
+        if (conn.ssl) {
+            int n = SSL_write(conn.ssl, data, (int)len);
+            if (n > 0) return n;
+            want = sslWant(conn.ssl, n);
+            ERR_clear_error();
+            return want ? 0 : -1;
+        }
+        ssize_t n = send(conn.fd, data, len, MSG_NOSIGNAL);
+        if (n >= 0) return n;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) { want = SocketPoller::kWrite; return 0; }
+        return -1;
+    }
+
+    // Appends everything currently readable to conn.readBuffer.
+    // Returns bytes read (possibly 0) with want set when blocked or eof set
+    // when the peer closed, -1 on error.
+    static long ioRead(Connection& conn, int& want, bool& eof) {
+        thread_local std::vector<char> scratch(16384);
+        long total = 0;
+        while (true) {
+            long n;
+            if (conn.ssl) {
+                n = SSL_read(conn.ssl, scratch.data(), (int)scratch.size());
+                if (n <= 0) {
+                    int err = SSL_get_error(conn.ssl, (int)n);
+                    ERR_clear_error();
+                    if (err == SSL_ERROR_WANT_READ) { want = SocketPoller::kRead; return total; }
+                    if (err == SSL_ERROR_WANT_WRITE) { want = SocketPoller::kWrite; return total; }
+                    if (err == SSL_ERROR_ZERO_RETURN || (err == SSL_ERROR_SYSCALL && n == 0)) { eof = true; return total; }
+                    return total > 0 ? total : -1;
+                }
+            } else {
+                n = recv(conn.fd, scratch.data(), scratch.size(), 0);
+                if (n < 0) {
+                    if (errno == EAGAIN || errno == EWOULDBLOCK) { want = SocketPoller::kRead; return total; }
+                    return total > 0 ? total : -1;
+                }
+                if (n == 0) { eof = true; return total; }
+            }
+            conn.readBuffer.append(scratch.data(), n);
+            total += n;
+        }
+    }
+
+    static std::string lower(std::string s) {
+        for (auto& c : s) c = (char)std::tolower((unsigned char)c);
+        return s;
+    }
+
+    // Parses what has arrived so far; returns true once the body is complete
+    static bool parseResponse(Request& req) {
+        const std::string& buf = req.conn->readBuffer;
+        if (!req.headerEnd) {
+            size_t end = buf.find("\r\n\r\n");
+            if (end == std::string::npos) return false;
+            req.headerEnd = end + 4;
+
+            size_t lineEnd = buf.find("\r\n");
+            std::string statusLine = buf.substr(0, lineEnd);
+            size_t sp = statusLine.find(' ');
+            req.status = sp == std::string::npos ? 0 : std::atoi(statusLine.c_str() + sp + 1);
+            if (statusLine.compare(0, 8, "HTTP/1.0") == 0) req.keepAlive = false;
+
+            size_t pos = lineEnd + 2;
+            while (pos < end) {
+                size_t next = buf.find("\r\n", pos);
+                std::string line = buf.substr(pos, next - pos);
+                pos = next + 2;
+                size_t colon = line.find(':');
+                if (colon == std::string::npos) continue;
+                std::string name = lower(line.substr(0, colon));
+                std::string value = line.substr(colon + 1);
+                value.erase(0, value.find_first_not_of(" \t"));
+                if (name == "content-length") req.contentLength = std::atoll(value.c_str());
+                else if (name == "transfer-encoding" && lower(value).find("chunked") != std::string::npos) req.chunked = true;
+                else if (name == "connection") req.keepAlive = lower(value).find("close") == std::string::npos;
+            }
+            if (req.status == 204 || req.status == 304) req.contentLength = 0;
+            req.chunkPos = req.headerEnd;
+        }
+
+        if (req.chunked) {
+            while (true) {
+                size_t lineEnd = buf.find("\r\n", req.chunkPos);
+                if (lineEnd == std::string::npos) return false;
+                size_t size = std::strtoul(buf.c_str() + req.chunkPos, nullptr, 16);
+                if (size == 0) {
+                    // Last chunk, then optional trailers and a blank line
+                    size_t trailerEnd = buf.find("\r\n", lineEnd + 2);
+                    while (trailerEnd != std::string::npos && trailerEnd != lineEnd + 2) {
+                        lineEnd = trailerEnd;
+                        trailerEnd = buf.find("\r\n", lineEnd + 2);
+                    }
+                    return trailerEnd != std::string::npos;
+                }
+                if (buf.size() < lineEnd + 2 + size + 2) return false;
+                req.body.append(buf, lineEnd + 2, size);
+                req.chunkPos = lineEnd + 2 + size + 2;
+            }
+        }
+        if (req.contentLength >= 0) {
+            if (buf.size() < req.headerEnd + (size_t)req.contentLength) return false;
+            req.body.assign(buf, req.headerEnd, (size_t)req.contentLength);
+            return true;
+        }
+        return false; // close-delimited, completes at EOF
+    }
+
+    void finish(Request& req, SocketPoller& poller) {
+        poller.remove(req.conn->fd);
+        if (req.keepAlive) {
+            releaseIdle(req.key, std::move(req.conn));
+        } else {
+            closeConnection(*req.conn);
+            req.conn.reset();
+        }
+        if (req.status < 200 || req.status >= 300) {
+            std::cerr << "HTTP " << req.status << " for URL: " << req.rawUrl << std::endl;
+            req.body.clear();
+        }
+        req.state = State::Done;
+    }
+
+    void fail(Request& req, SocketPoller& poller) {
+        if (req.conn) {
+            poller.remove(req.conn->fd);
+            closeConnection(*req.conn);
+            req.conn.reset();
+        }
+        req.state = State::Failed;
+    }
+
+    // A pooled connection may have been closed by the server while idle;
+    // retry once on a fresh connection before giving up.
+    void retryOrFail(Request& req, SocketPoller& poller) {
+        bool stale = req.conn && req.conn->reused && !req.retried && req.conn->readBuffer.empty();
+        if (!stale) {
+            std::cerr << "Connection error for URL: " << req.rawUrl << std::endl;
+            return fail(req, poller);
+        }
+        poller.remove(req.conn->fd);
+        closeConnection(*req.conn);
+        req.conn.reset();
+        req.retried = true;
+        req.addressesTried = 0;
+        if (!openConnection(req)) {
+            req.state = State::Failed;
+            return;
+        }
+        req.outPos = 0;
+        advance(req, poller);
+    }
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// Learns when the games API cache refreshes a universe's values.
+// Every poll that sees a new value brackets the refresh between the
+// previous poll and this one. Once enough changes have been seen, the
+// period is bounded by intersecting the gaps between brackets (gaps that
+// span several refreshes count as multiples) and the brackets are folded
+// onto one period and intersected, which narrows down the refresh phase.
+// Polls can then be placed just after each predicted refresh instead of on
+// a blind fixed interval.
+class RefreshEstimator {
+public:
+    static constexpr size_t kMinChanges = 4;   // brackets needed before trusting the fit
+    static constexpr size_t kMaxBrackets = 32;
+    static constexpr int kMissRetries = 2;     // quick retries when a predicted refresh is late
+    static constexpr int kMaxMisses = 8;       // polls in a row without a change before relearning
+    static constexpr int64_t kMinPeriodMs = 1000;
+
+    // Call after every successful poll
+    void observe(int64_t pollMs, bool changed) {
+        if (changed) {
+            idlePolls = 0;
+            misses = 0;
+            if (lastPollMs >= 0) {
+                brackets.push_back({lastPollMs, pollMs});
+                if (brackets.size() > kMaxBrackets) brackets.pop_front();
+                fit();
+            }
+        } else {
+            idlePolls++;
+            if (learned() && ++misses >= kMaxMisses) reset();
+        }
+        lastPollMs = pollMs;
+    }
+
+    bool learned() const { return periodMs > 0; }
+    int64_t getPeriodMs() const { return periodMs; }
+
+    // Next time worth polling. When learned: marginMs after the next
+    // predicted refresh, or marginMs from now (a few times) if the last
+    // predicted refresh has not shown up yet; an early poll still narrows
+    // the phase. Otherwise a probe, backing off (up to 8x) while
+    // nothing changes.
+    int64_t nextPollMs(int64_t nowMs, int64_t probeMs, int64_t marginMs) const {
+        // A refresh that still does not show up after the retries most
+        // likely left the value unchanged; wait for the next one
+        if (learned() && misses % (kMissRetries + 1) != 0) return nowMs + marginMs;
+        if (!learned()) {
+            int shift = std::min(idlePolls / 4, 3);
+            return nowMs + (probeMs << shift);
+        }
+        int64_t target = refreshMs + periodMs + marginMs;
+        if (target <= nowMs) {
+            int64_t periods = (nowMs - target) / periodMs + 1;
+            target += periods * periodMs;
+        }
+        return target;
+    }
+
+private:
+    struct Bracket {
+        int64_t lo; // last poll that still saw the old value
+        int64_t hi; // first poll that saw the new value
+    };
+
+    std::deque<Bracket> brackets;
+    int64_t lastPollMs = -1;
+    int64_t periodMs = 0;
+    int64_t refreshMs = 0; // best estimate of the latest refresh
+    int idlePolls = 0;
+    int misses = 0;
+
+    void reset() {
+        periodMs = 0;
+        misses = 0;
+        brackets.clear();
+    }
+
+    void fit() {
+        if (brackets.size() < kMinChanges) return;
+
+        // Period: refreshes i-1 and i lie in their brackets, so their gap is
+        // within (cur.lo - prev.hi, cur.hi - prev.lo). A refresh that left
+        // the value unchanged makes a gap span k periods; k is the smallest
+        // multiple that fits under the tightest single-period bound. Gaps
+        // measured from the oldest bracket spread the same slack over all
+        // the periods in between, which narrows the bounds as changes accrue.
+        int64_t upper = INT64_MAX;
+        for (size_t i = 1; i < brackets.size(); i++)
+            upper = std::min(upper, brackets[i].hi - brackets[i - 1].lo);
+        int64_t lower = kMinPeriodMs;
+        std::vector<int64_t> periods(brackets.size(), 0); // refreshes since the oldest bracket
+        for (size_t i = 1; i < brackets.size(); i++) {
+            int64_t gapLo = brackets[i].lo - brackets[i - 1].hi;
+            periods[i] = periods[i - 1] + std::max<int64_t>(1, (gapLo + upper - 1) / upper);
+            lower = std::max(lower, (brackets[i].lo - brackets[0].hi) / periods[i]);
+            upper = std::min(upper, (brackets[i].hi - brackets[0].lo) / periods[i]);
+        }
+        if (lower > upper) {
+            // Inconsistent (period or phase changed); keep recent evidence only
+            brackets.pop_front();
+            return fit();
+        }
+        int64_t period = (lower + upper) / 2;
+        if (upper - lower > period / 8) return; // not narrow enough yet
+
+        // Phase: every bracket bounds the latest refresh once carried forward
+        // by the periods in between
+        int64_t lo = INT64_MIN, hi = INT64_MAX;
+        for (size_t i = 0; i < brackets.size(); i++) {
+            int64_t span = periods.back() - periods[i];
+            lo = std::max(lo, brackets[i].lo + span * lower);
+            hi = std::min(hi, brackets[i].hi + span * upper);
+        }
+        if (lo >= hi) {
+            brackets.pop_front();
+            return fit();
+        }
+        periodMs = period;
+        refreshMs = lo + (hi - lo) / 2;
+    }
+};
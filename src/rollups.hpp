@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "game_data.hpp"
+#include "checksum.hpp"
+
+// Pre-aggregated CCU per time bucket, at four resolutions. Buckets are
+// aligned to UTC multiples of their width (so days run from 00:00 UTC)
+// and only exist for periods that have samples.
+struct RollupBucket {
+    int64_t startMs;
+    uint64_t sum;
+    uint32_t min;
+    uint32_t max;
+    uint32_t first;
+    uint32_t last;
+    uint32_t count;
+    uint32_t checksum; // FNV-1a of the other fields, set when the bucket is written
+
+    static RollupBucket begin(int64_t startMs, uint32_t ccu) {
+        return RollupBucket{startMs, ccu, ccu, ccu, ccu, ccu, 1, 0};
+    }
+
+    void add(uint32_t ccu) {
+        sum += ccu;
+        if (ccu < min) min = ccu;
+        if (ccu > max) max = ccu;
+        last = ccu;
+        count++;
+    }
+
+    double mean() const { return count ? (double)sum / count : 0.0; }
+
+    static uint32_t computeChecksum(const RollupBucket& bucket) {
+        return fnv1a(&bucket, offsetof(RollupBucket, checksum));
+    }
+    void seal() { checksum = computeChecksum(*this); }
+    bool valid() const { return checksum == computeChecksum(*this); }
+};
+
+static_assert(sizeof(RollupBucket) == 40, "rollup layout must not have padding");
+
+struct RollupTier {
+    const char* extension; // of the per-game file next to the sample segment
+    int64_t widthMs;
+    int64_t retentionMs;   // older buckets are dropped, 0 = kept forever
+};
+
+enum RollupTierIndex { kRollup1Min, kRollup5Min, kRollup1Hour, kRollup1Day, kRollupTierCount };
+
+// The fine tiers only cover recent history: with minute samples a 1 min
+// bucket is as big as the raw sample, and far bigger than it compressed
+constexpr RollupTier kRollupTiers[kRollupTierCount] = {
+    {".r1m", 60LL * 1000, 7LL * 24 * 60 * 60 * 1000},
+    {".r5m", 5LL * 60 * 1000, 30LL * 24 * 60 * 60 * 1000},
+    {".r1h", 60LL * 60 * 1000, 0},
+    {".r1d", 24LL * 60 * 60 * 1000, 0},
+};
+
+// Start of the bucket containing timeMs (floor, also before 1970)
+inline int64_t rollupBucketStart(int64_t timeMs, int64_t widthMs) {
+    int64_t start = timeMs - timeMs % widthMs;
+    return start > timeMs ? start - widthMs : start;
+}
+
+// Keeps the open bucket of one tier for one game. Samples must come in
+// time order; a sample in a later bucket completes the open one.
+class RollupBuilder {
+public:
+    explicit RollupBuilder(int64_t widthMs = kRollupTiers[kRollup1Min].widthMs) : widthMs(widthMs) {}
+
+    // Returns true (with the completed bucket in closed) if sample started a new bucket
+    bool add(const GameData& sample, RollupBucket& closed) {
+        int64_t start = rollupBucketStart(sample.timestampMs, widthMs);
+        if (hasOpen && start == bucket.startMs) {
+            bucket.add(sample.ccu);
+            return false;
+        }
+        bool completed = hasOpen;
+        if (completed) {
+            closed = bucket;
+            closed.seal();
+        }
+        bucket = RollupBucket::begin(start, sample.ccu);
+        hasOpen = true;
+        return completed;
+    }
+
+    // The bucket still collecting samples, if any
+    const RollupBucket* open() const { return hasOpen ? &bucket : nullptr; }
+    int64_t getWidthMs() const { return widthMs; }
+
+private:
+    int64_t widthMs;
+    RollupBucket bucket{};
+    bool hasOpen = false;
+};
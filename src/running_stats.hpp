@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "game_data.hpp"
+#include "vote_velocity.hpp"
+
+// O(1) running summary of one field: count, min/max with their sample index
+// and time, Welford mean/variance, and first/last values.
+struct FieldStats {
+    uint64_t count = 0;
+    double min = 0.0, max = 0.0;
+    size_t minIndex = 0, maxIndex = 0;
+    int64_t minTimeMs = 0, maxTimeMs = 0;
+    double first = 0.0, last = 0.0;
+    int64_t firstTimeMs = 0, lastTimeMs = 0;
+    double mean = 0.0;
+    double m2 = 0.0; // sum of squared deviations from the mean
+
+    void add(double value, size_t index, int64_t timeMs) {
+        if (count == 0) {
+            min = max = first = value;
+            minIndex = maxIndex = index;
+            minTimeMs = maxTimeMs = firstTimeMs = timeMs;
+        } else {
+            // Strict comparisons keep the earliest sample on ties
+            if (value < min) { min = value; minIndex = index; minTimeMs = timeMs; }
+            if (value > max) { max = value; maxIndex = index; maxTimeMs = timeMs; }
+        }
+        last = value;
+        lastTimeMs = timeMs;
+
+        count++;
+        double delta = value - mean;
+        mean += delta / count;
+        m2 += delta * (value - mean);
+    }
+
+    bool empty() const { return count == 0; }
+    double variance() const { return count > 1 ? m2 / (count - 1) : 0.0; }
+    double stddev() const { return std::sqrt(variance()); }
+    double change() const { return last - first; }
+};
+
+// Running summary of a game's samples, updated on every push_back.
+// Samples without votes (withVotes false) only count towards the CCU.
+struct SeriesStats {
+    FieldStats ccu;
+    FieldStats rating;
+    VoteVelocity votes; // from the raw counts, not the rating
+
+    void add(const GameData& data, size_t index, bool withVotes = true) {
+        ccu.add(data.ccu, index, data.timestampMs);
+        if (!withVotes) return;
+        rating.add(data.rating(), index, data.timestampMs);
+        votes.add(data);
+    }
+};
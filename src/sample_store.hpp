@@ -0,0 +1,1018 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include "game_data.hpp"
+#include "checksum.hpp"
+#include "mapped_file.hpp"
+#include "gorilla_codec.hpp"
+#include "rollups.hpp"
+#include "tdigest.hpp"
+#include "seasonal_baseline.hpp"
+
+// Binary time series on disk, two files per game in one directory:
+//
+//   <universeId>.rms   append-only tail of raw samples
+//     SegmentHeader         32 bytes: magic "RMSS", version, record size,
+//                           universe ID, creation time
+//     SampleRecord[]        24 bytes each: timestamp, ccu, up/down votes,
+//                           FNV-1a checksum of the other fields
+//
+//   <universeId>.rmz   archive of sealed, compressed blocks
+//     SegmentHeader         magic "RMSZ", record size 0
+//     { FrameHeader, Gorilla block }[]
+//
+//   <universeId>.r1m, .r5m, .r1h, .r1d   CCU rollups per tier
+//     SegmentHeader         magic "RMSR", record size 40
+//     RollupBucket[]        completed buckets in time order
+//
+//   <universeId>.q1d   CCU t-digest per completed UTC day
+//     SegmentHeader         magic "RMSQ", record size 0
+//     { DigestFrameHeader, serialized TDigest }[]
+//
+//   <universeId>.hwb   hour-of-week CCU baseline
+//     SegmentHeader         magic "RMSB", record size 2320
+//     SeasonalBaseline      rewritten in place when an hour completes
+//
+// Every sample is durably appended to the tail first. Once kBlockSamples
+// have accumulated they are sealed into one compressed block, appended to
+// the archive, and the tail is cut back to what is not archived yet. Raw
+// records are fixed size, so a tail opens in constant time; a crash can at
+// worst leave a torn last record or frame, which readers skip and the next
+// writer cuts off. Samples that were archived just before a crash and are
+// still in the tail are recognised by timestamp and skipped.
+//
+// Rollups are updated as samples are written: each tier keeps its open
+// bucket in memory and appends it once a sample lands in a later bucket.
+// Tiers with a retention are cut back to it once they hold twice as much.
+// The open buckets are rebuilt from the raw samples after the last
+// written bucket on the first write of a run (which also fills in
+// rollups for data stored before there were any). Day digests are kept
+// the same way, alongside the day tier, and the seasonal baseline is fed
+// every completed 1 h bucket. The baseline can always be rebuilt from the
+// 1 h tier (which is kept forever), so it is overwritten in place and a
+// torn write only costs a rebuild.
+
+struct SegmentHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t reserved;
+    uint64_t universeId;
+    int64_t createdMs;
+};
+
+struct SampleRecord {
+    int64_t timestampMs;
+    uint32_t ccu;
+    uint32_t upVotes;
+    uint32_t downVotes;
+    uint32_t checksum;
+
+    static uint32_t computeChecksum(const SampleRecord& record) {
+        return fnv1a(&record, offsetof(SampleRecord, checksum));
+    }
+
+    static SampleRecord from(const GameData& data) {
+        SampleRecord record{data.timestampMs, data.ccu, data.upVotes, data.downVotes, 0};
+        record.checksum = computeChecksum(record);
+        return record;
+    }
+
+    bool valid() const { return checksum == computeChecksum(*this); }
+    GameData toGameData() const { return GameData{timestampMs, ccu, upVotes, downVotes}; }
+};
+
+static_assert(sizeof(SegmentHeader) == 32 && sizeof(SampleRecord) == 24, "segment layout must not have padding");
+
+// Flushes, syncs to disk and closes; false if any step (or ok) failed
+inline bool syncAndClose(FILE* file, bool ok) {
+    ok = std::fflush(file) == 0 && ok;
+#ifdef _WIN32
+    ok = _commit(_fileno(file)) == 0 && ok;
+#else
+    ok = fsync(fileno(file)) == 0 && ok;
+#endif
+    return std::fclose(file) == 0 && ok;
+}
+
+constexpr char kSegmentMagic[4] = {'R', 'M', 'S', 'S'};
+constexpr char kArchiveMagic[4] = {'R', 'M', 'S', 'Z'};
+constexpr char kRollupMagic[4] = {'R', 'M', 'S', 'R'};
+constexpr char kDigestMagic[4] = {'R', 'M', 'S', 'Q'};
+constexpr const char* kDigestExtension = ".q1d";
+constexpr char kBaselineMagic[4] = {'R', 'M', 'S', 'B'};
+constexpr const char* kBaselineExtension = ".hwb";
+constexpr uint32_t kSegmentVersion = 1;
+
+// Precedes every compressed block in an archive
+struct FrameHeader {
+    uint32_t byteLength; // of the block that follows
+    uint32_t count;      // samples in the block
+    uint32_t checksum;   // FNV-1a of the block bytes
+    uint32_t reserved;
+    int64_t firstMs;
+    int64_t lastMs;
+};
+
+// Precedes every day digest
+struct DigestFrameHeader {
+    int64_t startMs;     // of the UTC day
+    uint32_t byteLength; // of the serialized digest that follows
+    uint32_t checksum;   // FNV-1a of those bytes
+};
+
+static_assert(sizeof(FrameHeader) == 32 && sizeof(DigestFrameHeader) == 16, "frame layout must not have padding");
+
+// Read-only view of one game's segment
+class SampleSegment {
+public:
+    bool open(const std::string& path) {
+        count = 0;
+        if (!file.map(path) || file.size() < sizeof(SegmentHeader)) return false;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, kSegmentMagic, sizeof(header.magic)) != 0 ||
+            header.version != kSegmentVersion || header.recordSize != sizeof(SampleRecord)) {
+            return false;
+        }
+        // A partial record at the end is ignored
+        count = (file.size() - sizeof(SegmentHeader)) / sizeof(SampleRecord);
+        return true;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    uint64_t universeId() const { return header.universeId; }
+
+    const SampleRecord& record(size_t i) const {
+        return reinterpret_cast<const SampleRecord*>(file.data() + sizeof(SegmentHeader))[i];
+    }
+
+    // False if record i is torn or damaged
+    bool valid(size_t i) const { return record(i).valid(); }
+    GameData at(size_t i) const { return record(i).toGameData(); }
+
+    // Index of the first record at or after timeMs (records are appended in time order)
+    size_t lowerBound(int64_t timeMs) const {
+        size_t lo = 0, hi = count;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (record(mid).timestampMs < timeMs) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+private:
+    MappedFile file;
+    SegmentHeader header{};
+    size_t count = 0;
+};
+
+// Read-only view of one game's archive. Opening scans only the frame
+// headers; blocks are checked and decoded on demand.
+class SeriesArchive {
+public:
+    struct Block {
+        size_t offset; // of the block bytes
+        uint32_t byteLength;
+        uint32_t count;
+        uint32_t checksum;
+        int64_t firstMs;
+        int64_t lastMs;
+    };
+
+    bool open(const std::string& path) {
+        blocks.clear();
+        if (!file.map(path) || file.size() < sizeof(SegmentHeader)) return false;
+        SegmentHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, kArchiveMagic, sizeof(header.magic)) != 0 || header.version != kSegmentVersion)
+            return false;
+        blocks = scanFrames(file.data(), file.size());
+        return true;
+    }
+
+    // Frames up to the first torn one
+    static std::vector<Block> scanFrames(const char* data, size_t size) {
+        std::vector<Block> found;
+        size_t pos = sizeof(SegmentHeader);
+        while (size - pos >= sizeof(FrameHeader)) {
+            FrameHeader frame;
+            std::memcpy(&frame, data + pos, sizeof(frame));
+            pos += sizeof(frame);
+            if (frame.byteLength > size - pos || frame.count == 0) break;
+            found.push_back(Block{pos, frame.byteLength, frame.count, frame.checksum, frame.firstMs, frame.lastMs});
+            pos += frame.byteLength;
+        }
+        return found;
+    }
+
+    size_t blockCount() const { return blocks.size(); }
+    const Block& block(size_t i) const { return blocks[i]; }
+    size_t sampleCount() const {
+        size_t total = 0;
+        for (const auto& b : blocks) total += b.count;
+        return total;
+    }
+    int64_t lastMs() const { return blocks.empty() ? INT64_MIN : blocks.back().lastMs; }
+
+    // Appends block i's samples to out; false if it is damaged
+    bool decodeBlock(size_t i, std::vector<GameData>& out) const {
+        const Block& b = blocks[i];
+        const char* bytes = file.data() + b.offset;
+        if (fnv1a(bytes, b.byteLength) != b.checksum) return false;
+        return decodeGorillaBlock(reinterpret_cast<const uint8_t*>(bytes), b.byteLength, b.count, out);
+    }
+
+    // Appends every intact block's samples at or after fromMs to out
+    void decodeAll(std::vector<GameData>& out, int64_t fromMs = INT64_MIN) const {
+        for (size_t i = 0; i < blocks.size(); i++) {
+            if (blocks[i].lastMs < fromMs) continue;
+            size_t start = out.size();
+            decodeBlock(i, out);
+            if (blocks[i].firstMs < fromMs) {
+                auto keep = std::lower_bound(out.begin() + start, out.end(), fromMs,
+                    [](const GameData& d, int64_t t) { return d.timestampMs < t; });
+                out.erase(out.begin() + start, keep);
+            }
+        }
+    }
+
+private:
+    MappedFile file;
+    std::vector<Block> blocks;
+};
+
+// Read-only view of one game's rollup tier
+class RollupFile {
+public:
+    bool open(const std::string& path) {
+        count = 0;
+        if (!file.map(path) || file.size() < sizeof(SegmentHeader)) return false;
+        SegmentHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, kRollupMagic, sizeof(header.magic)) != 0 ||
+            header.version != kSegmentVersion || header.recordSize != sizeof(RollupBucket)) {
+            return false;
+        }
+        count = (file.size() - sizeof(SegmentHeader)) / sizeof(RollupBucket);
+        return true;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    const RollupBucket& bucket(size_t i) const {
+        return reinterpret_cast<const RollupBucket*>(file.data() + sizeof(SegmentHeader))[i];
+    }
+
+    // Index of the first bucket starting at or after timeMs
+    size_t lowerBound(int64_t timeMs) const {
+        size_t lo = 0, hi = count;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (bucket(mid).startMs < timeMs) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+private:
+    MappedFile file;
+    size_t count = 0;
+};
+
+// Read-only view of one game's day digests. Opening scans the frame
+// headers up to the first torn one.
+class DigestFile {
+public:
+    struct Frame {
+        size_t offset; // of the digest bytes
+        int64_t startMs;
+        uint32_t byteLength;
+        uint32_t checksum;
+    };
+
+    bool open(const std::string& path) {
+        frames.clear();
+        if (!file.map(path) || file.size() < sizeof(SegmentHeader)) return false;
+        SegmentHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, kDigestMagic, sizeof(header.magic)) != 0 || header.version != kSegmentVersion)
+            return false;
+        size_t pos = sizeof(SegmentHeader);
+        while (file.size() - pos >= sizeof(DigestFrameHeader)) {
+            DigestFrameHeader frame;
+            std::memcpy(&frame, file.data() + pos, sizeof(frame));
+            pos += sizeof(frame);
+            if (frame.byteLength > file.size() - pos) break;
+            frames.push_back(Frame{pos, frame.startMs, frame.byteLength, frame.checksum});
+            pos += frame.byteLength;
+        }
+        return true;
+    }
+
+    size_t size() const { return frames.size(); }
+    const Frame& frame(size_t i) const { return frames[i]; }
+    bool valid(size_t i) const { return fnv1a(file.data() + frames[i].offset, frames[i].byteLength) == frames[i].checksum; }
+
+    // False if frame i is damaged
+    bool read(size_t i, TDigest& digest) const {
+        if (!valid(i)) return false;
+        const char* pos = file.data() + frames[i].offset;
+        return digest.deserialize(pos, pos + frames[i].byteLength);
+    }
+
+private:
+    MappedFile file;
+    std::vector<Frame> frames;
+};
+
+// Writes samples to the per-game files. append() only queues the record;
+// flush() (once per sampling tick) appends every queued record with one
+// write per game, syncs it to disk and seals full blocks into the
+// archive. Files are only open while they are written, so large
+// watchlists never run out of handles.
+//
+// Appends are idempotent: a record no newer than the last one stored for
+// its game is dropped, so samples replayed from a session journal can be
+// appended again safely. When the journal already makes each tick
+// durable, setSyncWrites(false) leaves the tail appends in the OS cache
+// and sync() flushes them before the journal lets go of those ticks.
+class SampleStore {
+public:
+    // Samples per compressed block (about four hours of minute samples)
+    static constexpr uint32_t kBlockSamples = 256;
+
+    // ROBLOX_MONITOR_DATA overrides the directory
+    static std::string defaultDirectory() {
+        const char* env = std::getenv("ROBLOX_MONITOR_DATA");
+        return (env && *env) ? env : "samples";
+    }
+
+    explicit SampleStore(std::string directory = defaultDirectory()) : directory(std::move(directory)) {}
+    ~SampleStore() { flush(); }
+    SampleStore(const SampleStore&) = delete;
+    SampleStore& operator=(const SampleStore&) = delete;
+
+    const std::string& getDirectory() const { return directory; }
+
+    std::string segmentPath(const std::string& universeId) const {
+        return (std::filesystem::path(directory) / (universeId + ".rms")).string();
+    }
+
+    std::string archivePath(const std::string& universeId) const {
+        return (std::filesystem::path(directory) / (universeId + ".rmz")).string();
+    }
+
+    void append(const std::string& universeId, const GameData& data) {
+        queued[universeId].push_back(SampleRecord::from(data));
+    }
+
+    // The sample of a snapshot; a failed one has none and is dropped, so
+    // its placeholder zeros never become history (and rollups, digests,
+    // baselines)
+    void append(const std::string& universeId, const GameSnapshot& snapshot) {
+        if (!snapshot.failed) append(universeId, snapshot.data);
+    }
+
+    void setSyncWrites(bool sync) { syncWrites = sync; }
+
+    // Syncs every tail appended to without syncing since the last call
+    bool sync() {
+        bool ok = true;
+        for (const auto& path : unsynced) {
+            FILE* file = std::fopen(path.c_str(), "ab");
+            ok = file && syncAndClose(file, true) && ok;
+        }
+        unsynced.clear();
+        return ok;
+    }
+
+    // Returns false if any segment could not be written; its records stay queued
+    bool flush() {
+        if (queued.empty()) return true;
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+
+        bool ok = true;
+        for (auto it = queued.begin(); it != queued.end();) {
+            if (writeSegment(it->first, it->second)) {
+                it = queued.erase(it);
+            } else {
+                ok = false;
+                ++it;
+            }
+        }
+        if (!ok && !reportedError) {
+            std::cerr << "Could not write samples to " << directory << std::endl;
+            reportedError = true;
+        }
+        return ok;
+    }
+
+    std::string rollupPath(const std::string& universeId, size_t tier) const {
+        return (std::filesystem::path(directory) / (universeId + kRollupTiers[tier].extension)).string();
+    }
+
+    std::string digestPath(const std::string& universeId) const {
+        return (std::filesystem::path(directory) / (universeId + kDigestExtension)).string();
+    }
+
+    std::string baselinePath(const std::string& universeId) const {
+        return (std::filesystem::path(directory) / (universeId + kBaselineExtension)).string();
+    }
+
+    // The seasonal baseline kept up to date by this run's writes; nullptr
+    // before the game's first flush
+    const SeasonalBaseline* baseline(const std::string& universeId) const {
+        auto it = openBlocks.find(universeId);
+        return it != openBlocks.end() ? &it->second.baseline : nullptr;
+    }
+
+    bool open(const std::string& universeId, SampleSegment& segment) const {
+        return segment.open(segmentPath(universeId));
+    }
+
+    // Full stored history of a game (archive blocks, then the unsealed
+    // tail), oldest first, from fromMs on
+    std::vector<GameData> readSeries(const std::string& universeId, int64_t fromMs = INT64_MIN) const {
+        std::vector<GameData> out;
+        SeriesArchive archive;
+        int64_t archivedUntil = INT64_MIN;
+        if (archive.open(archivePath(universeId))) {
+            archive.decodeAll(out, fromMs);
+            archivedUntil = archive.lastMs();
+        }
+        SampleSegment tail;
+        if (open(universeId, tail)) {
+            for (size_t i = tail.lowerBound(std::max(fromMs, archivedUntil)); i < tail.size(); i++) {
+                const SampleRecord& record = tail.record(i);
+                if (record.valid() && record.timestampMs > archivedUntil) out.push_back(record.toGameData());
+            }
+        }
+        return out;
+    }
+
+    // Buckets of a rollup tier that overlap [fromMs, toMs), oldest first.
+    // Written buckets are read straight from the tier file; only the
+    // samples after the last written bucket (normally just the open one)
+    // are aggregated from the raw series.
+    std::vector<RollupBucket> readRollups(const std::string& universeId, size_t tier,
+                                          int64_t fromMs = INT64_MIN, int64_t toMs = INT64_MAX) const {
+        std::vector<RollupBucket> out;
+        int64_t width = kRollupTiers[tier].widthMs;
+        int64_t from = fromMs == INT64_MIN ? fromMs : rollupBucketStart(fromMs, width);
+        int64_t writtenUntil = INT64_MIN;
+        RollupFile file;
+        if (file.open(rollupPath(universeId, tier))) {
+            for (size_t i = file.lowerBound(from); i < file.size(); i++) {
+                const RollupBucket& bucket = file.bucket(i);
+                if (!bucket.valid()) break;
+                writtenUntil = bucket.startMs + width;
+                if (bucket.startMs < toMs) out.push_back(bucket);
+            }
+            if (writtenUntil == INT64_MIN && !file.empty() && file.bucket(file.size() - 1).valid())
+                writtenUntil = file.bucket(file.size() - 1).startMs + width; // all before fromMs
+        }
+        if (writtenUntil >= toMs) return out;
+
+        RollupBuilder builder(width);
+        RollupBucket closed;
+        for (const GameData& sample : readSeries(universeId, std::max(from, writtenUntil))) {
+            if (sample.timestampMs >= toMs) break;
+            if (builder.add(sample, closed)) out.push_back(closed);
+        }
+        if (builder.open()) out.push_back(*builder.open());
+        return out;
+    }
+
+    // CCU digest of the UTC days overlapping [fromMs, toMs), merged from the
+    // stored day digests plus the samples after the last stored day
+    TDigest readCcuDigest(const std::string& universeId, int64_t fromMs = INT64_MIN, int64_t toMs = INT64_MAX) const {
+        TDigest merged;
+        int64_t dayMs = kRollupTiers[kRollup1Day].widthMs;
+        int64_t from = fromMs == INT64_MIN ? fromMs : rollupBucketStart(fromMs, dayMs);
+        int64_t writtenUntil = INT64_MIN;
+        DigestFile file;
+        if (file.open(digestPath(universeId))) {
+            for (size_t i = 0; i < file.size(); i++) {
+                const DigestFile::Frame& frame = file.frame(i);
+                if (!file.valid(i)) break;
+                writtenUntil = frame.startMs + dayMs;
+                if (frame.startMs < from || frame.startMs >= toMs) continue;
+                TDigest day;
+                if (file.read(i, day)) merged.merge(day);
+            }
+        }
+        if (writtenUntil >= toMs) return merged;
+        for (const GameData& sample : readSeries(universeId, std::max(from, writtenUntil))) {
+            if (sample.timestampMs >= toMs) break;
+            merged.add(sample.ccu);
+        }
+        return merged;
+    }
+
+    // Seasonal baseline of a game as stored, brought up to date with the
+    // 1 h buckets written after it
+    SeasonalBaseline readBaseline(const std::string& universeId) const {
+        SeasonalBaseline baseline;
+        loadBaseline(universeId, baseline);
+        return baseline;
+    }
+
+private:
+    std::string directory;
+    std::unordered_map<std::string, std::vector<SampleRecord>> queued;
+    bool reportedError = false;
+    bool syncWrites = true;
+    std::unordered_set<std::string> unsynced; // tails written with syncWrites off
+
+    // Unsealed block of each game written this run
+    struct OpenBlock {
+        GorillaEncoder encoder;
+        int64_t archivedUntilMs = INT64_MIN;
+        int64_t storedUntilMs = INT64_MIN; // newest sample in the archive or tail
+        RollupBuilder rollups[kRollupTierCount];
+        std::vector<RollupBucket> unwritten[kRollupTierCount]; // completed, not in the tier file yet
+        int64_t firstWrittenMs[kRollupTierCount];               // oldest bucket in the tier file
+        // Digest of the current UTC day, and completed days not in the digest file yet
+        TDigest dayDigest;
+        int64_t dayDigestMs = INT64_MIN;
+        std::string unwrittenDigests; // DigestFrameHeader + bytes each
+        SeasonalBaseline baseline;
+        bool baselineDirty = false; // changed since it was last written
+    };
+    std::unordered_map<std::string, OpenBlock> openBlocks;
+
+    // Closes a file that was appended to or created, syncing it now or
+    // (with syncWrites off) at the next sync()
+    bool closeWritten(FILE* file, bool ok, const std::string& path) {
+        if (syncWrites) return syncAndClose(file, ok);
+        unsynced.insert(path);
+        return std::fclose(file) == 0 && ok;
+    }
+
+    static SegmentHeader makeHeader(const char (&magic)[4], uint32_t recordSize, const std::string& universeId) {
+        SegmentHeader header{};
+        std::memcpy(header.magic, magic, sizeof(header.magic));
+        header.version = kSegmentVersion;
+        header.recordSize = recordSize;
+        header.universeId = std::strtoull(universeId.c_str(), nullptr, 10);
+        header.createdMs = nowEpochMs();
+        return header;
+    }
+
+    bool writeSegment(const std::string& universeId, const std::vector<SampleRecord>& records) {
+        std::string path = segmentPath(universeId);
+        auto blockIt = openBlocks.find(universeId);
+        if (blockIt == openBlocks.end()) {
+            // First write of this run: repair both files and reload the unsealed tail
+            OpenBlock block;
+            if (!repairArchive(universeId, block.archivedUntilMs) || !repairTail(path, universeId)) return false;
+            SampleSegment tail;
+            if (tail.open(path)) {
+                for (size_t i = 0; i < tail.size(); i++) {
+                    if (tail.valid(i) && tail.record(i).timestampMs > block.archivedUntilMs)
+                        block.encoder.add(tail.at(i));
+                }
+            }
+            block.storedUntilMs = block.encoder.empty() ? block.archivedUntilMs : block.encoder.back().timestampMs;
+            if (!reloadRollups(universeId, block)) return false;
+            blockIt = openBlocks.emplace(universeId, std::move(block)).first;
+        }
+
+        OpenBlock& block = blockIt->second;
+        int64_t storedBefore = block.storedUntilMs;
+        std::vector<SampleRecord> fresh;
+        for (const auto& record : records) {
+            if (record.timestampMs <= block.storedUntilMs) continue; // already stored
+            fresh.push_back(record);
+            block.storedUntilMs = record.timestampMs;
+        }
+        if (fresh.empty()) return true;
+
+        FILE* file = std::fopen(path.c_str(), "ab");
+        if (!file) return false;
+        bool ok = std::fwrite(fresh.data(), sizeof(SampleRecord), fresh.size(), file) == fresh.size();
+        if (!closeWritten(file, ok, path)) {
+            block.storedUntilMs = storedBefore; // retried with the queued records
+            return false;
+        }
+
+        bool sealed = false;
+        for (const auto& record : fresh) {
+            GameData sample = record.toGameData();
+            block.encoder.add(sample);
+            // A block that fails to seal stays in the tail and is retried on the next sample
+            if (block.encoder.size() >= kBlockSamples && sealBlock(universeId, block)) sealed = true;
+            addToRollups(block, sample);
+        }
+        if (sealed) compactTail(path, block.archivedUntilMs);
+        writeRollups(universeId, block);
+        return true;
+    }
+
+    void addToRollups(OpenBlock& block, const GameData& sample) {
+        RollupBucket closed;
+        for (size_t tier = 0; tier < kRollupTierCount; tier++) {
+            if (block.rollups[tier].add(sample, closed)) {
+                block.unwritten[tier].push_back(closed);
+                if (tier == kRollup1Hour) addToBaseline(block, closed);
+            }
+        }
+        addToDayDigest(block, sample);
+    }
+
+    static void addToBaseline(OpenBlock& block, const RollupBucket& hour) {
+        if (block.baseline.addHour(hour.startMs, hour.mean())) block.baselineDirty = true;
+    }
+
+    static void addToDayDigest(OpenBlock& block, const GameData& sample) {
+        int64_t day = rollupBucketStart(sample.timestampMs, kRollupTiers[kRollup1Day].widthMs);
+        if (day != block.dayDigestMs) {
+            if (!block.dayDigest.empty()) {
+                std::string bytes;
+                block.dayDigest.serialize(bytes);
+                DigestFrameHeader frame{block.dayDigestMs, (uint32_t)bytes.size(), fnv1a(bytes.data(), bytes.size())};
+                block.unwrittenDigests.append(reinterpret_cast<const char*>(&frame), sizeof(frame));
+                block.unwrittenDigests.append(bytes);
+            }
+            block.dayDigest = TDigest();
+            block.dayDigestMs = day;
+        }
+        block.dayDigest.add(sample.ccu);
+    }
+
+    // Appends completed buckets to their tier files. Buckets that cannot be
+    // written are kept and retried with the next ones, so a tier never has gaps.
+    bool writeRollups(const std::string& universeId, OpenBlock& block) {
+        bool ok = true;
+        for (size_t tier = 0; tier < kRollupTierCount; tier++) {
+            std::vector<RollupBucket>& buckets = block.unwritten[tier];
+            if (buckets.empty()) continue;
+            // Tier files are created with their first bucket, so short runs
+            // of large watchlists do not create four extra files per game
+            std::string path = rollupPath(universeId, tier);
+            std::error_code ec;
+            bool exists = std::filesystem::exists(path, ec);
+            FILE* file = std::fopen(path.c_str(), exists ? "ab" : "wb");
+            bool written = file != nullptr;
+            if (file && !exists) {
+                SegmentHeader header = makeHeader(kRollupMagic, sizeof(RollupBucket), universeId);
+                written = std::fwrite(&header, sizeof(header), 1, file) == 1;
+            }
+            written = written && std::fwrite(buckets.data(), sizeof(RollupBucket), buckets.size(), file) == buckets.size();
+            if (file) written = closeWritten(file, written, path);
+            ok = ok && written;
+            if (!written) continue;
+
+            int64_t& first = block.firstWrittenMs[tier];
+            if (first == INT64_MIN) first = buckets.front().startMs;
+            int64_t newest = buckets.back().startMs;
+            buckets.clear();
+            int64_t retention = kRollupTiers[tier].retentionMs;
+            if (retention > 0 && newest - first > 2 * retention && trimRollupFile(path, newest - retention))
+                first = newest - retention;
+        }
+
+        if (!block.unwrittenDigests.empty()) {
+            std::string path = digestPath(universeId);
+            std::error_code ec;
+            bool exists = std::filesystem::exists(path, ec);
+            FILE* file = std::fopen(path.c_str(), exists ? "ab" : "wb");
+            bool written = file != nullptr;
+            if (file && !exists) {
+                SegmentHeader header = makeHeader(kDigestMagic, 0, universeId);
+                written = std::fwrite(&header, sizeof(header), 1, file) == 1;
+            }
+            const std::string& bytes = block.unwrittenDigests;
+            written = written && std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+            if (file) written = closeWritten(file, written, path);
+            if (written) block.unwrittenDigests.clear();
+            ok = ok && written;
+        }
+
+        if (block.baselineDirty) {
+            bool written = writeBaseline(universeId, block.baseline);
+            if (written) block.baselineDirty = false;
+            ok = ok && written;
+        }
+        return ok;
+    }
+
+    // Overwrites the baseline file in place (created with the first completed hour)
+    bool writeBaseline(const std::string& universeId, SeasonalBaseline baseline) {
+        std::string path = baselinePath(universeId);
+        std::error_code ec;
+        bool exists = std::filesystem::exists(path, ec);
+        FILE* file = std::fopen(path.c_str(), exists ? "r+b" : "wb");
+        if (!file) return false;
+        SegmentHeader header = makeHeader(kBaselineMagic, sizeof(SeasonalBaseline), universeId);
+        baseline.seal();
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  std::fwrite(&baseline, sizeof(baseline), 1, file) == 1;
+        return closeWritten(file, ok, path);
+    }
+
+    // Reads the stored baseline (starting over if it is missing or damaged)
+    // and folds in the 1 h buckets written after it. Returns true if the
+    // stored one was already up to date.
+    bool loadBaseline(const std::string& universeId, SeasonalBaseline& baseline) const {
+        baseline = SeasonalBaseline();
+        FILE* file = std::fopen(baselinePath(universeId).c_str(), "rb");
+        if (file) {
+            SegmentHeader header;
+            bool ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+                      std::memcmp(header.magic, kBaselineMagic, sizeof(header.magic)) == 0 &&
+                      header.recordSize == sizeof(SeasonalBaseline) &&
+                      std::fread(&baseline, sizeof(baseline), 1, file) == 1 && baseline.valid();
+            std::fclose(file);
+            if (!ok) baseline = SeasonalBaseline();
+        }
+        bool current = true;
+        RollupFile hours;
+        if (hours.open(rollupPath(universeId, kRollup1Hour))) {
+            for (size_t i = hours.lowerBound(baseline.getUpdatedUntilMs()); i < hours.size(); i++) {
+                const RollupBucket& hour = hours.bucket(i);
+                if (!hour.valid()) break;
+                if (baseline.addHour(hour.startMs, hour.mean())) current = false;
+            }
+        }
+        return current;
+    }
+
+    // Drops the buckets before cutoffMs (temp file + rename)
+    bool trimRollupFile(const std::string& path, int64_t cutoffMs) {
+        std::string tempPath = path + ".tmp";
+        FILE* out = nullptr;
+        bool ok = false;
+        {
+            RollupFile file;
+            if (!file.open(path)) return false;
+            out = std::fopen(tempPath.c_str(), "wb");
+            if (!out) return false;
+            SegmentHeader header;
+            FILE* in = std::fopen(path.c_str(), "rb");
+            ok = in && std::fread(&header, sizeof(header), 1, in) == 1;
+            if (in) std::fclose(in);
+            size_t keep = file.lowerBound(cutoffMs);
+            size_t count = file.size() - keep;
+            ok = ok && std::fwrite(&header, sizeof(header), 1, out) == 1 &&
+                 (count == 0 || std::fwrite(&file.bucket(keep), sizeof(RollupBucket), count, out) == count);
+        }
+        if (!syncAndClose(out, ok)) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec) std::remove(tempPath.c_str());
+        return !ec;
+    }
+
+    // Repairs the tier files and rebuilds the open buckets (and any
+    // missing completed ones) from the samples after the last written bucket
+    bool reloadRollups(const std::string& universeId, OpenBlock& block) {
+        int64_t writtenUntil[kRollupTierCount];
+        int64_t from = INT64_MAX;
+        for (size_t tier = 0; tier < kRollupTierCount; tier++) {
+            block.rollups[tier] = RollupBuilder(kRollupTiers[tier].widthMs);
+            if (!repairRollupFile(universeId, tier, block.firstWrittenMs[tier], writtenUntil[tier])) return false;
+            from = std::min(from, writtenUntil[tier]);
+        }
+        int64_t digestsUntil;
+        if (!repairDigestFile(universeId, digestsUntil)) return false;
+        from = std::min(from, digestsUntil);
+        block.baselineDirty = !loadBaseline(universeId, block.baseline);
+        for (const GameData& sample : readSeries(universeId, from)) {
+            RollupBucket closed;
+            for (size_t tier = 0; tier < kRollupTierCount; tier++) {
+                if (sample.timestampMs < writtenUntil[tier]) continue;
+                if (block.rollups[tier].add(sample, closed)) {
+                    block.unwritten[tier].push_back(closed);
+                    if (tier == kRollup1Hour) addToBaseline(block, closed);
+                }
+            }
+            if (sample.timestampMs >= digestsUntil) addToDayDigest(block, sample);
+        }
+        writeRollups(universeId, block);
+        return true;
+    }
+
+    // Cuts torn or damaged frames off the digest file and reports where
+    // its stored days end
+    bool repairDigestFile(const std::string& universeId, int64_t& writtenUntilMs) {
+        namespace fs = std::filesystem;
+        std::string path = digestPath(universeId);
+        writtenUntilMs = INT64_MIN;
+        std::error_code ec;
+        uintmax_t size = fs::exists(path, ec) ? fs::file_size(path, ec) : 0;
+        if (ec) return false;
+
+        if (size >= sizeof(SegmentHeader)) {
+            uintmax_t validEnd = 0;
+            {
+                DigestFile file;
+                if (file.open(path)) {
+                    validEnd = sizeof(SegmentHeader);
+                    for (size_t i = 0; i < file.size() && file.valid(i); i++) {
+                        validEnd = file.frame(i).offset + file.frame(i).byteLength;
+                        writtenUntilMs = file.frame(i).startMs + kRollupTiers[kRollup1Day].widthMs;
+                    }
+                }
+            }
+            if (validEnd > 0) {
+                if (validEnd != size) fs::resize_file(path, validEnd, ec);
+                return !ec;
+            }
+            fs::rename(path, path + ".bad", ec);
+            return !ec;
+        }
+        if (size > 0) fs::remove(path, ec);
+        return !ec;
+    }
+
+    // Cuts a torn or damaged last bucket off a tier file and reports where
+    // its written buckets start and end
+    bool repairRollupFile(const std::string& universeId, size_t tier, int64_t& firstWrittenMs, int64_t& writtenUntilMs) {
+        namespace fs = std::filesystem;
+        std::string path = rollupPath(universeId, tier);
+        firstWrittenMs = INT64_MIN;
+        writtenUntilMs = INT64_MIN;
+        std::error_code ec;
+        uintmax_t size = fs::exists(path, ec) ? fs::file_size(path, ec) : 0;
+        if (ec) return false;
+
+        if (size >= sizeof(SegmentHeader)) {
+            uintmax_t validEnd = 0;
+            {
+                RollupFile file;
+                if (file.open(path)) {
+                    size_t count = file.size();
+                    while (count > 0 && !file.bucket(count - 1).valid()) count--;
+                    if (count > 0) {
+                        firstWrittenMs = file.bucket(0).startMs;
+                        writtenUntilMs = file.bucket(count - 1).startMs + kRollupTiers[tier].widthMs;
+                    }
+                    validEnd = sizeof(SegmentHeader) + count * sizeof(RollupBucket);
+                }
+            }
+            if (validEnd > 0) {
+                if (validEnd != size) fs::resize_file(path, validEnd, ec);
+                return !ec;
+            }
+            fs::rename(path, path + ".bad", ec);
+            return !ec;
+        }
+        // Torn before its header was complete; recreated with the next bucket
+        if (size > 0) fs::remove(path, ec);
+        return !ec;
+    }
+
+    // Appends the open block to the archive and starts a new one
+    bool sealBlock(const std::string& universeId, OpenBlock& block) {
+        const std::vector<uint8_t>& bytes = block.encoder.data();
+        FrameHeader frame{(uint32_t)bytes.size(), block.encoder.size(), fnv1a(bytes.data(), bytes.size()), 0,
+                          block.encoder.front().timestampMs, block.encoder.back().timestampMs};
+        FILE* file = std::fopen(archivePath(universeId).c_str(), "ab");
+        if (!file) return false;
+        bool ok = std::fwrite(&frame, sizeof(frame), 1, file) == 1 &&
+                  std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+        if (!syncAndClose(file, ok)) return false;
+        block.archivedUntilMs = frame.lastMs;
+        block.encoder.clear();
+        return true;
+    }
+
+    // Rewrites the tail without the samples that are now archived (temp
+    // file + rename, so a crash leaves either the old or the new tail)
+    bool compactTail(const std::string& path, int64_t archivedUntilMs) {
+        std::vector<SampleRecord> keep;
+        SegmentHeader header;
+        {
+            SampleSegment tail;
+            if (!tail.open(path)) return false;
+            FILE* in = std::fopen(path.c_str(), "rb");
+            if (!in) return false;
+            bool readOk = std::fread(&header, sizeof(header), 1, in) == 1;
+            std::fclose(in);
+            if (!readOk) return false;
+            for (size_t i = tail.lowerBound(archivedUntilMs + 1); i < tail.size(); i++)
+                if (tail.valid(i)) keep.push_back(tail.record(i));
+        }
+
+        std::string tempPath = path + ".tmp";
+        FILE* out = std::fopen(tempPath.c_str(), "wb");
+        if (!out) return false;
+        bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1 &&
+                  std::fwrite(keep.data(), sizeof(SampleRecord), keep.size(), out) == keep.size();
+        if (!syncAndClose(out, ok)) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec) std::remove(tempPath.c_str());
+        return !ec;
+    }
+
+    // Cuts a torn last frame off the archive (or creates it) and reports
+    // the newest archived timestamp
+    bool repairArchive(const std::string& universeId, int64_t& archivedUntilMs) {
+        namespace fs = std::filesystem;
+        std::string path = archivePath(universeId);
+        archivedUntilMs = INT64_MIN;
+        std::error_code ec;
+        uintmax_t size = fs::exists(path, ec) ? fs::file_size(path, ec) : 0;
+        if (ec) return false;
+
+        if (size >= sizeof(SegmentHeader)) {
+            size_t validEnd = 0;
+            {
+                MappedFile file;
+                if (!file.map(path)) return false;
+                SegmentHeader header;
+                std::memcpy(&header, file.data(), sizeof(header));
+                if (std::memcmp(header.magic, kArchiveMagic, sizeof(header.magic)) == 0 &&
+                    header.version == kSegmentVersion) {
+                    validEnd = sizeof(SegmentHeader);
+                    for (const auto& block : SeriesArchive::scanFrames(file.data(), file.size())) {
+                        if (fnv1a(file.data() + block.offset, block.byteLength) != block.checksum) break;
+                        validEnd = block.offset + block.byteLength;
+                        archivedUntilMs = block.lastMs;
+                    }
+                }
+            }
+            if (validEnd > 0) {
+                if (validEnd != size) fs::resize_file(path, validEnd, ec);
+                return !ec;
+            }
+            fs::rename(path, path + ".bad", ec);
+            if (ec) return false;
+        }
+
+        SegmentHeader header = makeHeader(kArchiveMagic, 0, universeId);
+        FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+        return closeWritten(file, ok, path);
+    }
+
+    // Makes the segment end on a whole, valid record (or creates it with a
+    // header) before the first append of this run
+    bool repairTail(const std::string& path, const std::string& universeId) {
+        namespace fs = std::filesystem;
+        std::error_code ec;
+        uintmax_t size = fs::exists(path, ec) ? fs::file_size(path, ec) : 0;
+        if (ec) return false;
+
+        if (size >= sizeof(SegmentHeader)) {
+            SegmentHeader header;
+            FILE* file = std::fopen(path.c_str(), "rb");
+            if (!file) return false;
+            bool readOk = std::fread(&header, sizeof(header), 1, file) == 1;
+            uintmax_t aligned = size - (size - sizeof(SegmentHeader)) % sizeof(SampleRecord);
+            // Drop a torn last record
+            if (readOk && aligned > sizeof(SegmentHeader)) {
+                SampleRecord last;
+                readOk = std::fseek(file, (long)(aligned - sizeof(SampleRecord)), SEEK_SET) == 0 &&
+                         std::fread(&last, sizeof(last), 1, file) == 1;
+                if (readOk && !last.valid()) aligned -= sizeof(SampleRecord);
+            }
+            std::fclose(file);
+            if (readOk && std::memcmp(header.magic, kSegmentMagic, sizeof(header.magic)) == 0 &&
+                header.version == kSegmentVersion && header.recordSize == sizeof(SampleRecord)) {
+                if (aligned != size) fs::resize_file(path, aligned, ec);
+                return !ec;
+            }
+            // Not a segment of this version; keep it aside rather than append to it
+            fs::rename(path, path + ".bad", ec);
+            if (ec) return false;
+        }
+
+        SegmentHeader header = makeHeader(kSegmentMagic, sizeof(SampleRecord), universeId);
+        FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+        return closeWritten(file, ok, path);
+    }
+};
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "checksum.hpp"
+#include "game_data.hpp"
+
+// One sample compared with its expected CCU
+struct BaselineScore {
+    int64_t timeMs = 0;
+    uint32_t ccu = 0;
+    float expected = 0.0f;
+    float deviation = 0.0f; // typical spread around expected, never 0
+
+    double percent() const { return expected > 0 ? (ccu - (double)expected) / expected * 100.0 : 0.0; }
+    double z() const { return (ccu - (double)expected) / deviation; }
+};
+
+// What normal CCU is for each hour of the week, learned from the game's own
+// history: one slot per UTC hour of the week (Monday 00:00 = slot 0) with
+// an EWMA of that hour's mean CCU across weeks and an EWMA variance next to
+// it. Until a slot has seen its first week, the hour-of-day slot (the same
+// kind of average across days) stands in for it.
+//
+// The model is fed one completed hour at a time (the 1 h rollup buckets),
+// so updating and querying are O(1) and a sample is always compared with
+// hours before it. It is a flat struct so it can be stored as raw bytes.
+class SeasonalBaseline {
+public:
+    static constexpr int kHoursPerDay = 24;
+    static constexpr int kHoursPerWeek = 7 * kHoursPerDay;
+    static constexpr int64_t kHourMs = 60LL * 60 * 1000;
+    static constexpr double kWeekAlpha = 0.3; // weight of the newest week in a week slot
+    static constexpr double kDayAlpha = 0.2;  // weight of the newest day in a day slot
+    // Lower bound of the deviation relative to the expected CCU
+    static constexpr double kMinRelativeDeviation = 0.02;
+
+    // Folds in the mean CCU of the hour starting at hourStartMs. Hours must
+    // come in time order; one already folded in is ignored (false).
+    bool addHour(int64_t hourStartMs, double meanCcu) {
+        if (hourStartMs < updatedUntilMs) return false;
+        week[hourOfWeek(hourStartMs)].add(meanCcu, kWeekAlpha);
+        day[hourOfWeek(hourStartMs) % kHoursPerDay].add(meanCcu, kDayAlpha);
+        updatedUntilMs = hourStartMs + kHourMs;
+        return true;
+    }
+
+    // Scores a sample against its hour's slot; false while there is no
+    // history for that hour yet
+    bool score(const GameData& data, BaselineScore& out) const {
+        int slot = hourOfWeek(data.timestampMs);
+        const Slot& expected = week[slot].count > 0 ? week[slot] : day[slot % kHoursPerDay];
+        if (expected.count == 0) return false;
+        out.timeMs = data.timestampMs;
+        out.ccu = data.ccu;
+        out.expected = expected.mean;
+        double floor = std::fmax(1.0, kMinRelativeDeviation * expected.mean);
+        out.deviation = (float)std::fmax(std::sqrt((double)expected.variance), floor);
+        return true;
+    }
+
+    bool empty() const { return updatedUntilMs == INT64_MIN; }
+    // End of the last hour folded in
+    int64_t getUpdatedUntilMs() const { return updatedUntilMs; }
+
+    static uint32_t computeChecksum(const SeasonalBaseline& baseline) {
+        return fnv1a(&baseline, offsetof(SeasonalBaseline, checksum));
+    }
+    void seal() { checksum = computeChecksum(*this); }
+    bool valid() const { return checksum == computeChecksum(*this); }
+
+    // Slot of a time: hours since Monday 00:00 UTC (1970-01-01 was a Thursday)
+    static int hourOfWeek(int64_t timeMs) {
+        int64_t hours = timeMs / kHourMs - (timeMs % kHourMs < 0 ? 1 : 0);
+        int64_t slot = (hours + 3 * kHoursPerDay) % kHoursPerWeek;
+        return (int)(slot < 0 ? slot + kHoursPerWeek : slot);
+    }
+
+    // "Thu 20:00 UTC"
+    static std::string slotLabel(int64_t timeMs) {
+        static const char* const kDays[] = {"Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun"};
+        int slot = hourOfWeek(timeMs);
+        int hour = slot % kHoursPerDay;
+        return std::string(kDays[slot / kHoursPerDay]) + (hour < 10 ? " 0" : " ") + std::to_string(hour) + ":00 UTC";
+    }
+
+private:
+    struct Slot {
+        float mean = 0.0f;
+        float variance = 0.0f;
+        uint32_t count = 0; // hours folded in
+
+        void add(double value, double alpha) {
+            if (count++ == 0) {
+                mean = (float)value;
+                return;
+            }
+            double diff = value - mean;
+            mean = (float)(mean + alpha * diff);
+            variance = (float)((1.0 - alpha) * (variance + alpha * diff * diff));
+        }
+    };
+
+    Slot week[kHoursPerWeek];
+    Slot day[kHoursPerDay];
+    int64_t updatedUntilMs = INT64_MIN;
+    uint32_t checksum = 0; // FNV-1a of the fields above, set when stored
+    uint32_t reserved = 0;
+};
+
+static_assert(sizeof(SeasonalBaseline) == 2320, "baseline layout must not have padding");
+
+// Running summary of a session's scores: the latest one and the furthest
+// below and above normal
+struct BaselineSummary {
+    uint64_t count = 0;
+    BaselineScore last, lowest, highest;
+
+    void add(const BaselineScore& score) {
+        if (count == 0 || score.z() < lowest.z()) lowest = score;
+        if (count == 0 || score.z() > highest.z()) highest = score;
+        last = score;
+        count++;
+    }
+
+    bool empty() const { return count == 0; }
+};
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "game_data.hpp"
+
+// Puts series sampled at their own instants (every game is fetched at a
+// slightly different time, and ticks drift) onto one common time grid, so
+// "the same minute" means the same instant for every game.
+//
+// Each series is given as columns (timestamps and values, sorted by time)
+// and comes out as one float column on the grid. Grid points without a
+// usable sample are NaN, so gaps stay visible instead of being papered
+// over. A gap is a missing sample: the monitor was not running, or the
+// fetch failed (failed ticks are never stored, see GameSnapshot::failed).
+// A stored 0 is a real empty game and aligns as 0. Alignment is one merge of
+// the sample and grid columns, O(samples + grid points) per series, and
+// the series are independent of each other.
+
+// startMs, startMs + stepMs, ... (size points)
+struct TimeGrid {
+    int64_t startMs = 0;
+    int64_t stepMs = 60000;
+    size_t size = 0;
+
+    int64_t at(size_t i) const { return startMs + (int64_t)i * stepMs; }
+
+    // Grid points within [fromMs, toMs], starting at fromMs rounded up to a
+    // multiple of stepMs (so grids of different runs line up)
+    static TimeGrid covering(int64_t fromMs, int64_t toMs, int64_t stepMs) {
+        TimeGrid grid;
+        grid.stepMs = stepMs;
+        int64_t start = fromMs - fromMs % stepMs;
+        grid.startMs = start < fromMs ? start + stepMs : start;
+        grid.size = toMs >= grid.startMs ? (size_t)((toMs - grid.startMs) / stepMs + 1) : 0;
+        return grid;
+    }
+};
+
+enum JoinMethod {
+    kJoinAsOf,  // latest sample at or before the grid point
+    kJoinLinear // straight line between the samples around the grid point
+};
+
+// One game's samples as columns
+struct SeriesColumns {
+    std::vector<int64_t> timestampsMs;
+    std::vector<uint32_t> ccus;
+
+    static SeriesColumns ccuOf(const std::vector<GameData>& samples) {
+        SeriesColumns columns;
+        columns.timestampsMs.reserve(samples.size());
+        columns.ccus.reserve(samples.size());
+        for (const auto& sample : samples) {
+            columns.timestampsMs.push_back(sample.timestampMs);
+            columns.ccus.push_back(sample.ccu);
+        }
+        return columns;
+    }
+
+    size_t size() const { return timestampsMs.size(); }
+};
+
+// Median time between consecutive samples (of at most kSpacingProbes
+// evenly spread pairs, which is plenty for a typical value); 0 with fewer
+// than two samples
+inline int64_t typicalSpacingMs(const int64_t* timesMs, size_t count) {
+    constexpr size_t kSpacingProbes = 1024;
+    if (count < 2) return 0;
+    size_t stride = std::max<size_t>(1, (count - 1) / kSpacingProbes);
+    std::vector<int64_t> spacings;
+    spacings.reserve(kSpacingProbes + 1);
+    for (size_t i = 0; i + 1 < count; i += stride) spacings.push_back(timesMs[i + 1] - timesMs[i]);
+    auto middle = spacings.begin() + spacings.size() / 2;
+    std::nth_element(spacings.begin(), middle, spacings.end());
+    return *middle;
+}
+
+// A sample reaches at most this far: up to the next sample if they are at
+// most half again the usual spacing apart, so one missed fetch in a
+// once-a-minute series is already a gap
+inline int64_t defaultMaxGapMs(const int64_t* timesMs, size_t count) {
+    return typicalSpacingMs(timesMs, count) * 3 / 2;
+}
+
+// Writes grid.size values to out. With kJoinAsOf a grid point gets the
+// latest sample at or before it, if that is at most maxGapMs old; with
+// kJoinLinear it is interpolated between the samples around it, if those
+// are at most maxGapMs apart. Anything else is NaN (a grid point right on
+// a sample always gets it).
+//
+// Grid points and samples are merged in one pass with no search per
+// point, so a month of minute samples aligns in well under a millisecond
+// per game.
+inline void alignColumn(const int64_t* timesMs, const uint32_t* values, size_t count, const TimeGrid& grid,
+                        JoinMethod method, int64_t maxGapMs, float* out) {
+    const float gap = std::numeric_limits<float>::quiet_NaN();
+    // First sample after the current grid point; the one before it is the as-of sample
+    size_t next = std::upper_bound(timesMs, timesMs + count, grid.startMs) - timesMs;
+    int64_t timeMs = grid.startMs;
+    for (size_t k = 0; k < grid.size; k++, timeMs += grid.stepMs) {
+        while (next < count && timesMs[next] <= timeMs) next++;
+        float value = gap;
+        if (next > 0) {
+            size_t previous = next - 1;
+            int64_t t0 = timesMs[previous];
+            if (t0 == timeMs) {
+                value = (float)values[previous];
+            } else if (method == kJoinAsOf) {
+                if (timeMs - t0 <= maxGapMs) value = (float)values[previous];
+            } else if (next < count && timesMs[next] - t0 <= maxGapMs) {
+                double v0 = values[previous];
+                value = (float)(v0 + ((double)values[next] - v0) * (double)(timeMs - t0) / (double)(timesMs[next] - t0));
+            }
+        }
+        out[k] = value;
+    }
+}
+
+// Several games on one grid: columns[g][i] is game g at grid.at(i)
+struct AlignedTable {
+    TimeGrid grid;
+    std::vector<std::vector<float>> columns;
+
+    static bool isGap(float value) { return std::isnan(value); }
+
+    size_t gapCount(size_t column) const {
+        size_t gaps = 0;
+        for (float value : columns[column]) gaps += isGap(value) ? 1 : 0;
+        return gaps;
+    }
+};
+
+// Aligns every series to grid; maxGapMs 0 picks defaultMaxGapMs per series
+inline AlignedTable alignSeries(const std::vector<SeriesColumns>& series, const TimeGrid& grid,
+                                JoinMethod method, int64_t maxGapMs = 0) {
+    AlignedTable table;
+    table.grid = grid;
+    table.columns.resize(series.size());
+    for (size_t g = 0; g < series.size(); g++) {
+        const SeriesColumns& columns = series[g];
+        int64_t maxGap = maxGapMs > 0 ? maxGapMs : defaultMaxGapMs(columns.timestampsMs.data(), columns.size());
+        table.columns[g].resize(grid.size);
+        alignColumn(columns.timestampsMs.data(), columns.ccus.data(), columns.size(), grid, method, maxGap,
+                    table.columns[g].data());
+    }
+    return table;
+}
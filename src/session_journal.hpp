@@ -0,0 +1,354 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+#include "game_data.hpp"
+#include "running_stats.hpp"
+#include "drop_detector.hpp"
+#include "seasonal_baseline.hpp"
+#include "tdigest.hpp"
+#include "mapped_file.hpp"
+#include "sample_store.hpp"
+
+// Everything a monitor keeps besides its in-memory history, which is
+// rebuilt from the sample store on resume
+struct MonitorState {
+    uint64_t totalCount = 0;
+    SeriesStats stats;
+    int64_t firstVisits = -1, lastVisits = 0;
+    int64_t firstFavorites = -1, lastFavorites = 0;
+    DropDetector drops;
+    BaselineSummary baselineScores;
+    uint64_t missedCount = 0; // ticks without data
+};
+
+static_assert(std::is_trivially_copyable<MonitorState>::value, "monitor state is written as raw bytes");
+
+// Write-ahead log of a monitoring session, two files in the sample
+// directory:
+//
+//   session.ckpt   checkpoint: session settings, every monitor's state and
+//                  the next tick's wall time, replaced atomically
+//                  (temp file + rename)
+//     CheckpointHeader
+//     universe IDs          u32 length + bytes each
+//     MonitorState[count]
+//     TDigest[count]        CCU digests, serialized
+//     u32                   FNV-1a of everything before it
+//
+//   session.wal    ticks since the checkpoint, appended and synced once per
+//                  tick (one write for the whole watchlist, with an entry
+//                  for every game sampled or missed on it)
+//     { RecordHeader, Entry[entryCount] }[]
+//
+// Every kCheckpointTicks ticks the states are checkpointed and the log is
+// emptied. Recovery loads the checkpoint and replays the logged ticks
+// after it (a torn last record is ignored; records already covered by the
+// checkpoint are skipped by sequence number), so a restarted process can
+// pick up where the old one stopped. The files are removed when the
+// session ends normally.
+class SessionJournal {
+public:
+    static constexpr unsigned kCheckpointTicks = 60;
+
+    struct Config {
+        bool watchlistMode = true; // false = single game mode
+        bool countUpdates = false;
+        int duration = 0;
+        int64_t startedMs = 0;
+        std::vector<std::string> ids;
+    };
+
+    static constexpr uint32_t kEntryMissed = 1; // the tick failed for this game, only the time is real
+    static constexpr uint32_t kEntryVotes = 2;  // the votes arrived
+
+    // One game's tick; index is the game's position in Config::ids. Missed
+    // ticks are logged too, so replaying them restores the missed counts.
+    struct Entry {
+        uint32_t index;
+        uint32_t flags;
+        uint32_t ccu;
+        uint32_t upVotes;
+        uint32_t downVotes;
+        uint32_t reserved;
+        int64_t timestampMs;
+        int64_t visits;
+        int64_t favorites;
+
+        static Entry from(uint32_t index, const GameSnapshot& snapshot) {
+            const GameData& d = snapshot.data;
+            uint32_t flags = (snapshot.failed ? kEntryMissed : 0u) | (snapshot.hasVotes ? kEntryVotes : 0u);
+            return Entry{index, flags, d.ccu, d.upVotes, d.downVotes, 0,
+                         d.timestampMs, snapshot.visits, snapshot.favoritedCount};
+        }
+
+        GameSnapshot toSnapshot() const {
+            if (flags & kEntryMissed) return GameSnapshot::failedAt(timestampMs);
+            GameSnapshot snapshot;
+            snapshot.data = GameData{timestampMs, ccu, upVotes, downVotes};
+            snapshot.visits = visits;
+            snapshot.favoritedCount = favorites;
+            snapshot.hasVotes = (flags & kEntryVotes) != 0;
+            return snapshot;
+        }
+    };
+
+    struct Tick {
+        int64_t nextTickMs;
+        std::vector<Entry> entries;
+    };
+
+    struct Recovered {
+        Config config;
+        int64_t nextTickMs = 0; // 0 = no scheduled tick (sample-on-change mode)
+        std::vector<MonitorState> states;
+        std::vector<TDigest> digests;
+        std::vector<Tick> ticks; // logged after the checkpoint, oldest first
+        uint64_t lastSeq = 0;
+        uint64_t logBytes = 0;   // intact part of the log
+    };
+
+    explicit SessionJournal(std::string directory = SampleStore::defaultDirectory())
+        : directory(std::move(directory)) {}
+    ~SessionJournal() { closeLog(); }
+    SessionJournal(const SessionJournal&) = delete;
+    SessionJournal& operator=(const SessionJournal&) = delete;
+
+    std::string checkpointPath() const { return (std::filesystem::path(directory) / "session.ckpt").string(); }
+    std::string logPath() const { return (std::filesystem::path(directory) / "session.wal").string(); }
+
+    // True if an earlier session was interrupted
+    bool hasUnfinished() const {
+        std::error_code ec;
+        return std::filesystem::exists(checkpointPath(), ec);
+    }
+
+    // Starts a new session; nothing is written until the first checkpoint
+    void begin(const Config& settings) {
+        config = settings;
+        seq = 0;
+    }
+
+    // Continues a recovered session: its log is cut back to the last intact
+    // record and appended to, so the replayed ticks stay logged until the
+    // next checkpoint
+    void resume(const Recovered& recovered) {
+        config = recovered.config;
+        seq = recovered.lastSeq;
+        closeLog();
+        std::error_code ec;
+        if (std::filesystem::exists(logPath(), ec)) std::filesystem::resize_file(logPath(), recovered.logBytes, ec);
+    }
+
+    const Config& getConfig() const { return config; }
+
+    // Appends one tick and syncs it to disk
+    bool append(int64_t nextTickMs, const std::vector<Entry>& entries) {
+        if (!log) {
+            log = std::fopen(logPath().c_str(), "ab");
+            if (!log) return false;
+        }
+        RecordHeader header{0, 0, seq + 1, nextTickMs, (uint32_t)entries.size(), 0};
+        header.length = (uint32_t)(entries.size() * sizeof(Entry));
+        header.checksum = recordChecksum(header, entries.data());
+        bool ok = std::fwrite(&header, sizeof(header), 1, log) == 1 &&
+                  (entries.empty() || std::fwrite(entries.data(), sizeof(Entry), entries.size(), log) == entries.size());
+        ok = std::fflush(log) == 0 && ok;
+#ifdef _WIN32
+        ok = _commit(_fileno(log)) == 0 && ok;
+#else
+        ok = fsync(fileno(log)) == 0 && ok;
+#endif
+        if (ok) seq++;
+        return ok;
+    }
+
+    // Replaces the checkpoint with states (and each game's CCU digest) and
+    // empties the log. The samples of the logged ticks must be durable in
+    // the sample store first.
+    bool checkpoint(int64_t nextTickMs, const std::vector<MonitorState>& states,
+                    const std::vector<const TDigest*>& digests) {
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+
+        CheckpointHeader header{};
+        std::memcpy(header.magic, kCheckpointMagic, sizeof(header.magic));
+        header.version = kVersion;
+        header.flags = (config.watchlistMode ? kFlagWatchlist : 0u) | (config.countUpdates ? kFlagUpdates : 0u);
+        header.duration = config.duration;
+        header.startedMs = config.startedMs;
+        header.lastSeq = seq;
+        header.nextTickMs = nextTickMs;
+        header.gameCount = (uint32_t)config.ids.size();
+        header.stateSize = sizeof(MonitorState);
+
+        std::string bytes(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const auto& id : config.ids) {
+            uint32_t length = (uint32_t)id.size();
+            bytes.append(reinterpret_cast<const char*>(&length), sizeof(length));
+            bytes.append(id);
+        }
+        if (!states.empty())
+            bytes.append(reinterpret_cast<const char*>(states.data()), states.size() * sizeof(MonitorState));
+        for (const TDigest* digest : digests) digest->serialize(bytes);
+        uint32_t checksum = fnv1a(bytes.data(), bytes.size());
+        bytes.append(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+
+        std::string path = checkpointPath();
+        std::string tempPath = path + ".tmp";
+        FILE* file = std::fopen(tempPath.c_str(), "wb");
+        if (!file) return false;
+        bool ok = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+        if (!syncAndClose(file, ok)) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+
+        // Ticks up to seq are in the checkpoint now
+        closeLog();
+        log = std::fopen(logPath().c_str(), "wb");
+        return log != nullptr;
+    }
+
+    // Session ended normally: nothing to resume
+    void finish() {
+        closeLog();
+        std::remove(logPath().c_str());
+        std::remove(checkpointPath().c_str());
+    }
+
+    // Loads the interrupted session; false if there is none or its
+    // checkpoint is damaged
+    bool recover(Recovered& out) const {
+        MappedFile file;
+        if (!file.map(checkpointPath()) || file.size() < sizeof(CheckpointHeader) + sizeof(uint32_t)) return false;
+        const char* data = file.data();
+        size_t end = file.size() - sizeof(uint32_t);
+        uint32_t checksum;
+        std::memcpy(&checksum, data + end, sizeof(checksum));
+        if (fnv1a(data, end) != checksum) return false;
+
+        CheckpointHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, kCheckpointMagic, sizeof(header.magic)) != 0 || header.version != kVersion ||
+            header.stateSize != sizeof(MonitorState)) {
+            return false;
+        }
+
+        out = Recovered();
+        out.config.watchlistMode = (header.flags & kFlagWatchlist) != 0;
+        out.config.countUpdates = (header.flags & kFlagUpdates) != 0;
+        out.config.duration = header.duration;
+        out.config.startedMs = header.startedMs;
+        out.nextTickMs = header.nextTickMs;
+        out.lastSeq = header.lastSeq;
+
+        size_t pos = sizeof(header);
+        out.config.ids.reserve(header.gameCount);
+        for (uint32_t i = 0; i < header.gameCount; i++) {
+            uint32_t length;
+            if (end - pos < sizeof(length)) return false;
+            std::memcpy(&length, data + pos, sizeof(length));
+            pos += sizeof(length);
+            if (end - pos < length) return false;
+            out.config.ids.emplace_back(data + pos, length);
+            pos += length;
+        }
+        if ((end - pos) / sizeof(MonitorState) < header.gameCount) return false;
+        out.states.resize(header.gameCount);
+        if (header.gameCount > 0) std::memcpy(out.states.data(), data + pos, header.gameCount * sizeof(MonitorState));
+        pos += header.gameCount * sizeof(MonitorState);
+        const char* digestPos = data + pos;
+        out.digests.resize(header.gameCount);
+        for (auto& digest : out.digests)
+            if (!digest.deserialize(digestPos, data + end)) return false;
+
+        readLog(out);
+        return true;
+    }
+
+private:
+    static constexpr char kCheckpointMagic[4] = {'R', 'M', 'C', 'K'};
+    static constexpr uint32_t kVersion = 4;
+    static constexpr uint32_t kFlagWatchlist = 1;
+    static constexpr uint32_t kFlagUpdates = 2;
+
+    struct CheckpointHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t flags;
+        int32_t duration;
+        int64_t startedMs;
+        uint64_t lastSeq;    // newest log record the states include
+        int64_t nextTickMs;
+        uint32_t gameCount;
+        uint32_t stateSize;  // sizeof(MonitorState) of the writing build
+    };
+
+    struct RecordHeader {
+        uint32_t length;     // bytes of entries that follow
+        uint32_t checksum;   // FNV-1a of the rest of the header and the entries
+        uint64_t seq;
+        int64_t nextTickMs;
+        uint32_t entryCount;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(CheckpointHeader) == 48 && sizeof(RecordHeader) == 32 && sizeof(Entry) == 48,
+                  "journal layout must not have padding");
+
+    std::string directory;
+    Config config;
+    uint64_t seq = 0; // of the last appended record
+    FILE* log = nullptr;
+
+    void closeLog() {
+        if (log) std::fclose(log);
+        log = nullptr;
+    }
+
+    static uint32_t recordChecksum(const RecordHeader& header, const void* entries) {
+        size_t skip = offsetof(RecordHeader, seq);
+        uint32_t hash = fnv1a(reinterpret_cast<const char*>(&header) + skip, sizeof(header) - skip);
+        return fnv1a(entries, header.length, hash);
+    }
+
+    // Appends the logged ticks newer than the checkpoint, up to the first
+    // torn or damaged record
+    void readLog(Recovered& out) const {
+        MappedFile file;
+        if (!file.map(logPath())) return;
+        const char* data = file.data();
+        size_t size = file.size();
+        size_t pos = 0;
+        while (size - pos >= sizeof(RecordHeader)) {
+            RecordHeader header;
+            std::memcpy(&header, data + pos, sizeof(header));
+            pos += sizeof(header);
+            if (header.length > size - pos || header.length != header.entryCount * sizeof(Entry) ||
+                recordChecksum(header, data + pos) != header.checksum) {
+                break;
+            }
+            out.logBytes = pos + header.length;
+            if (header.seq > out.lastSeq) {
+                Tick tick{header.nextTickMs, std::vector<Entry>(header.entryCount)};
+                if (header.entryCount > 0) std::memcpy(tick.entries.data(), data + pos, header.length);
+                out.ticks.push_back(std::move(tick));
+                out.nextTickMs = header.nextTickMs;
+                out.lastSeq = header.seq;
+            }
+            pos += header.length;
+        }
+    }
+};
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "game_data.hpp"
+
+// Double-ended queue on a growable ring buffer: one contiguous block per
+// queue instead of std::deque's chunk map, which matters with several
+// small queues per game and thousands of games.
+template <typename T>
+class RingDeque {
+public:
+    void push_back(const T& value) {
+        if (count == slots.size()) grow();
+        slots[wrap(head + count)] = value;
+        count++;
+    }
+    void pop_front() { head = wrap(head + 1); count--; }
+    void pop_back() { count--; }
+    void clear() { head = 0; count = 0; }
+
+    T& front() { return slots[head]; }
+    const T& front() const { return slots[head]; }
+    const T& back() const { return slots[wrap(head + count - 1)]; }
+    const T& operator[](size_t i) const { return slots[wrap(head + i)]; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+private:
+    std::vector<T> slots;
+    size_t head = 0;
+    size_t count = 0;
+
+    size_t wrap(size_t i) const { return i < slots.size() ? i : i - slots.size(); }
+
+    void grow() {
+        std::vector<T> bigger(slots.empty() ? 8 : slots.size() * 2);
+        for (size_t i = 0; i < count; i++) bigger[i] = (*this)[i];
+        slots.swap(bigger);
+        head = 0;
+    }
+};
+
+// Low, peak and mean of CCU and rating over the last few minutes, for
+// several window lengths at once, amortized O(1) per sample.
+//
+// The samples of the longest window are kept once and shared. Each window
+// keeps running sums (a sample is added when it arrives and subtracted
+// when it falls out) and, per field, a monotonic deque of sample numbers:
+// the min deque only holds samples smaller than everything after them, so
+// its front is the window's minimum, and each sample is pushed and popped
+// at most once. The max deques work the same way. Samples without votes
+// only enter the CCU figures.
+class SlidingWindows {
+public:
+    struct Summary {
+        uint32_t count = 0;
+        uint32_t minCcu = 0, maxCcu = 0;
+        double meanCcu = 0.0;
+        uint32_t ratingCount = 0; // samples with votes; the rating figures are 0 without any
+        double minRating = 0.0, maxRating = 0.0;
+        double meanRating = 0.0;
+    };
+
+    explicit SlidingWindows(const std::vector<int64_t>& widthsMs) {
+        for (int64_t width : widthsMs) {
+            Window window;
+            window.widthMs = width;
+            windows.push_back(window);
+        }
+    }
+
+    // Samples must come in time order
+    void add(const GameData& data, bool withVotes = true) {
+        uint64_t seq = firstSeq + samples.size();
+        Sample sample{data.timestampMs, data.ccu, (float)data.rating(), withVotes};
+        samples.push_back(sample);
+
+        uint64_t oldestNeeded = seq;
+        for (auto& window : windows) {
+            window.ccuSum += sample.ccu;
+            while (!window.minCcu.empty() && at(window.minCcu.back()).ccu >= sample.ccu) window.minCcu.pop_back();
+            while (!window.maxCcu.empty() && at(window.maxCcu.back()).ccu <= sample.ccu) window.maxCcu.pop_back();
+            window.minCcu.push_back(seq);
+            window.maxCcu.push_back(seq);
+            if (sample.hasRating) {
+                window.ratingSum += sample.rating;
+                window.ratingCount++;
+                while (!window.minRating.empty() && at(window.minRating.back()).rating >= sample.rating) window.minRating.pop_back();
+                while (!window.maxRating.empty() && at(window.maxRating.back()).rating <= sample.rating) window.maxRating.pop_back();
+                window.minRating.push_back(seq);
+                window.maxRating.push_back(seq);
+            }
+
+            // Drop what is now older than the window
+            int64_t cutoffMs = sample.timeMs - window.widthMs;
+            while (at(window.first).timeMs <= cutoffMs) {
+                const Sample& old = at(window.first);
+                window.ccuSum -= old.ccu;
+                if (window.minCcu.front() == window.first) window.minCcu.pop_front();
+                if (window.maxCcu.front() == window.first) window.maxCcu.pop_front();
+                if (old.hasRating) {
+                    window.ratingSum -= old.rating;
+                    window.ratingCount--;
+                    if (window.minRating.front() == window.first) window.minRating.pop_front();
+                    if (window.maxRating.front() == window.first) window.maxRating.pop_front();
+                }
+                window.first++;
+            }
+            if (window.first < oldestNeeded) oldestNeeded = window.first;
+        }
+        while (firstSeq < oldestNeeded) {
+            samples.pop_front();
+            firstSeq++;
+        }
+    }
+
+    void clear() {
+        samples.clear();
+        firstSeq = 0;
+        for (auto& window : windows) {
+            int64_t width = window.widthMs;
+            window = Window();
+            window.widthMs = width;
+        }
+    }
+
+    size_t windowCount() const { return windows.size(); }
+    int64_t widthMs(size_t i) const { return windows[i].widthMs; }
+
+    // Figures of window i over the samples so far; count 0 before any sample
+    Summary summary(size_t i) const {
+        const Window& window = windows[i];
+        Summary result;
+        result.count = (uint32_t)(firstSeq + samples.size() - window.first);
+        if (result.count == 0) return result;
+        result.minCcu = at(window.minCcu.front()).ccu;
+        result.maxCcu = at(window.maxCcu.front()).ccu;
+        result.meanCcu = (double)window.ccuSum / result.count;
+        result.ratingCount = window.ratingCount;
+        if (result.ratingCount == 0) return result;
+        result.minRating = at(window.minRating.front()).rating;
+        result.maxRating = at(window.maxRating.front()).rating;
+        result.meanRating = window.ratingSum / result.ratingCount;
+        return result;
+    }
+
+private:
+    struct Sample {
+        int64_t timeMs;
+        uint32_t ccu;
+        float rating;
+        bool hasRating;
+    };
+
+    struct Window {
+        int64_t widthMs = 0;
+        uint64_t first = 0; // number of the oldest sample in the window
+        uint64_t ccuSum = 0;
+        double ratingSum = 0.0;
+        uint32_t ratingCount = 0;
+        RingDeque<uint64_t> minCcu, maxCcu, minRating, maxRating;
+    };
+
+    RingDeque<Sample> samples; // those of the longest window
+    uint64_t firstSeq = 0;     // number of samples.front()
+    std::vector<Window> windows;
+
+    const Sample& at(uint64_t seq) const { return samples[(size_t)(seq - firstSeq)]; }
+};
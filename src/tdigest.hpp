@@ -0,0 +1,181 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Merging t-digest (Dunning & Ertl): a quantile sketch of a stream of
+// values, kept as a bounded set of centroids (mean, weight). Centroids
+// near the median may hold many values, those near the tails only a few,
+// so extreme percentiles stay accurate. Size is bounded by the compression
+// (about compression * pi / 2 centroids) however many values are added,
+// and two digests merge into one of the same size, so percentiles over
+// many games or many days cost a merge, not a sort.
+//
+// New values go to a small buffer that is folded into the centroids when
+// it fills up or a quantile is asked for.
+class TDigest {
+public:
+    static constexpr double kDefaultCompression = 100;
+
+    explicit TDigest(double compression = kDefaultCompression) : compression(compression) {}
+
+    void add(double value, uint32_t weight = 1) {
+        if (weight == 0 || std::isnan(value)) return;
+        if (total == 0 && buffered == 0) minValue = maxValue = value;
+        minValue = std::min(minValue, value);
+        maxValue = std::max(maxValue, value);
+        buffer.push_back(Centroid{(float)value, weight});
+        buffered += weight;
+        if (buffer.size() >= kBufferSize) compress();
+    }
+
+    void merge(const TDigest& other) {
+        if (other.empty()) return;
+        if (empty()) {
+            minValue = other.minValue;
+            maxValue = other.maxValue;
+        } else {
+            minValue = std::min(minValue, other.minValue);
+            maxValue = std::max(maxValue, other.maxValue);
+        }
+        buffer.insert(buffer.end(), other.centroids.begin(), other.centroids.end());
+        buffer.insert(buffer.end(), other.buffer.begin(), other.buffer.end());
+        buffered += other.total + other.buffered;
+        compress();
+    }
+
+    uint64_t count() const { return total + buffered; }
+    bool empty() const { return count() == 0; }
+    double min() const { return minValue; }
+    double max() const { return maxValue; }
+
+    // Estimated value at quantile q (0..1); 0 if empty
+    double quantile(double q) const {
+        compress();
+        if (centroids.empty()) return 0.0;
+        if (q <= 0) return minValue;
+        if (q >= 1) return maxValue;
+        if (centroids.size() == 1) return centroids[0].mean;
+
+        // Each centroid's mean sits at the middle of its weight; between
+        // those points (and out to min/max at the ends) interpolate linearly
+        double index = q * (double)total;
+        const Centroid& first = centroids.front();
+        if (index < first.weight / 2.0) {
+            if (first.weight == 1) return minValue;
+            return minValue + (first.mean - minValue) * (index / (first.weight / 2.0));
+        }
+        double cumulative = first.weight / 2.0; // weight up to the current centroid's middle
+        for (size_t i = 0; i + 1 < centroids.size(); i++) {
+            const Centroid& left = centroids[i];
+            const Centroid& right = centroids[i + 1];
+            double step = (left.weight + right.weight) / 2.0;
+            if (index < cumulative + step) {
+                // A single value can not be spread out; keep it exact
+                if (left.weight == 1 && index - cumulative < 0.5) return left.mean;
+                if (right.weight == 1 && cumulative + step - index <= 0.5) return right.mean;
+                double t = (index - cumulative) / step;
+                return left.mean + (right.mean - left.mean) * t;
+            }
+            cumulative += step;
+        }
+        const Centroid& last = centroids.back();
+        if (last.weight == 1) return maxValue;
+        double t = (index - cumulative) / (last.weight / 2.0);
+        return last.mean + (maxValue - last.mean) * std::min(1.0, t);
+    }
+
+    // Folds the buffer into the centroids
+    void compress() const {
+        if (buffer.empty()) return;
+        buffer.insert(buffer.end(), centroids.begin(), centroids.end());
+        std::sort(buffer.begin(), buffer.end(), [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; });
+        total += buffered;
+        buffered = 0;
+        centroids.clear();
+
+        // Grow each centroid while the quantile range it covers stays
+        // within one unit of the scale function k
+        double weightSoFar = 0;
+        double limit = (double)total * qLimit(0);
+        Centroid current = buffer[0];
+        for (size_t i = 1; i < buffer.size(); i++) {
+            const Centroid& next = buffer[i];
+            if (weightSoFar + current.weight + next.weight <= limit) {
+                double weight = (double)current.weight + next.weight;
+                current.mean = (float)(current.mean + (next.mean - current.mean) * (next.weight / weight));
+                current.weight += next.weight;
+            } else {
+                weightSoFar += current.weight;
+                limit = (double)total * qLimit(weightSoFar / (double)total);
+                centroids.push_back(current);
+                current = next;
+            }
+        }
+        centroids.push_back(current);
+        buffer.clear();
+    }
+
+    // Compact binary form: count, min, max, then (mean, weight) per centroid
+    void serialize(std::string& out) const {
+        compress();
+        uint32_t n = (uint32_t)centroids.size();
+        out.append(reinterpret_cast<const char*>(&n), sizeof(n));
+        out.append(reinterpret_cast<const char*>(&minValue), sizeof(minValue));
+        out.append(reinterpret_cast<const char*>(&maxValue), sizeof(maxValue));
+        if (n > 0) out.append(reinterpret_cast<const char*>(centroids.data()), n * sizeof(Centroid));
+    }
+
+    // Reads what serialize() wrote, advancing pos; false if it does not fit
+    bool deserialize(const char*& pos, const char* end) {
+        uint32_t n;
+        if ((size_t)(end - pos) < sizeof(n) + 2 * sizeof(double)) return false;
+        std::memcpy(&n, pos, sizeof(n));
+        if ((size_t)(end - pos) - sizeof(n) - 2 * sizeof(double) < (size_t)n * sizeof(Centroid)) return false;
+        pos += sizeof(n);
+        std::memcpy(&minValue, pos, sizeof(minValue));
+        pos += sizeof(minValue);
+        std::memcpy(&maxValue, pos, sizeof(maxValue));
+        pos += sizeof(maxValue);
+        centroids.resize(n);
+        if (n > 0) std::memcpy(centroids.data(), pos, n * sizeof(Centroid));
+        pos += n * sizeof(Centroid);
+        buffer.clear();
+        buffered = 0;
+        total = 0;
+        for (const auto& c : centroids) total += c.weight;
+        return true;
+    }
+
+private:
+    // Float means are exact for CCU values up to 2^24
+    struct Centroid {
+        float mean;
+        uint32_t weight;
+    };
+    static_assert(sizeof(Centroid) == 8, "centroids are serialized as raw bytes");
+
+    static constexpr size_t kBufferSize = 32;
+
+    double compression;
+    mutable std::vector<Centroid> centroids; // sorted by mean
+    mutable std::vector<Centroid> buffer;
+    mutable uint64_t total = 0;              // weight in centroids
+    mutable uint64_t buffered = 0;           // weight in buffer
+    double minValue = 0, maxValue = 0;
+
+    // Scale function k1(q) = compression / (2 pi) * asin(2q - 1); returns
+    // the quantile one unit of k above q
+    double qLimit(double q) const {
+        const double pi = 3.14159265358979323846;
+        double k = compression / (2 * pi) * std::asin(2 * std::min(1.0, std::max(0.0, q)) - 1);
+        double next = k + 1;
+        double maxK = compression / 4;
+        if (next >= maxK) return 1.0;
+        return (std::sin(next * 2 * pi / compression) + 1) / 2;
+    }
+};
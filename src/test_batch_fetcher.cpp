@@ -0,0 +1,127 @@
+// Batch fetcher: a failed votes request leaves the CCU in place but marks
+// the samples as vote-less, and those stay out of the rating figures; a
+// games entry without a playing count is no sample
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "batch_fetcher.hpp"
+#include "running_stats.hpp"
+#include "sliding_window.hpp"
+#include "test_check.hpp"
+
+// Answers each endpoint with a fixed body; "" is a failed request
+class StandInTransport : public HttpTransport {
+public:
+    std::string games, votes;
+
+    std::string get(const std::string& url) override {
+        return url.find("/v1/games/votes?") != std::string::npos ? votes : games;
+    }
+    std::vector<std::string> getMany(const std::vector<std::string>& urls) override {
+        std::vector<std::string> responses;
+        for (const auto& url : urls) responses.push_back(get(url));
+        return responses;
+    }
+};
+
+const char* kGames = R"({"data":[{"id":1,"playing":5000,"visits":900,"favoritedCount":30},)"
+                     R"({"id":2,"playing":70,"visits":10,"favoritedCount":1}]})";
+const char* kVotes = R"({"data":[{"id":1,"upVotes":900,"downVotes":100},{"id":2,"upVotes":40,"downVotes":10}]})";
+
+int main() {
+    auto owned = std::unique_ptr<StandInTransport>(new StandInTransport());
+    StandInTransport& transport = *owned;
+    setHttpTransport(std::move(owned));
+    BatchFetcher fetcher("http://stand-in");
+
+    // Both requests answered
+    transport.games = kGames;
+    transport.votes = kVotes;
+    auto results = fetcher.fetch({"1", "2"}, false);
+    CHECK(results.size() == 2);
+    CHECK(results["1"].hasVotes && results["1"].data.upVotes == 900 && results["1"].data.downVotes == 100);
+    CHECK(results["2"].hasVotes && results["2"].data.rating() == 80.0);
+
+    // The votes request failed: CCU as usual, no votes
+    transport.votes = "";
+    auto failedVotes = fetcher.fetch({"1", "2"}, false);
+    CHECK(failedVotes.size() == 2);
+    CHECK(!failedVotes["1"].failed && failedVotes["1"].data.ccu == 5000);
+    CHECK(!failedVotes["1"].hasVotes && !failedVotes["2"].hasVotes);
+    CHECK(!failedVotes["1"].data.hasVotes());
+
+    // Cut off mid-response: the entries before the cut keep their votes
+    transport.votes = std::string(kVotes).substr(0, std::string(kVotes).find("{\"id\":2"));
+    auto partVotes = fetcher.fetch({"1", "2"}, false);
+    CHECK(partVotes["1"].hasVotes && !partVotes["2"].hasVotes);
+
+    // An entry without vote fields does not count as votes
+    transport.votes = R"({"data":[{"id":1},{"id":2,"upVotes":40,"downVotes":10}]})";
+    auto noFields = fetcher.fetch({"1", "2"}, false);
+    CHECK(!noFields["1"].hasVotes && noFields["2"].hasVotes);
+
+    // Only votes arrived: no samples at all
+    transport.games = "";
+    transport.votes = kVotes;
+    CHECK(fetcher.fetch({"1", "2"}, false).empty());
+
+    // A missing or null playing count fails the snapshot (its metadata is
+    // kept for validation), a real 0 does not
+    {
+        transport.games = R"({"data":[{"id":1,"name":"One","visits":900},{"id":2,"playing":null,"visits":10},)"
+                          R"({"id":3,"playing":0},{"id":4,"playing":12}]})";
+        transport.votes = "";
+        auto games = fetcher.fetch({"1", "2", "3", "4"}, true);
+        CHECK(games.size() == 4);
+        CHECK(games["1"].failed && games["1"].hasInfo && games["1"].info.name == "One");
+        CHECK(games["2"].failed);
+        CHECK(!games["3"].failed && games["3"].data.ccu == 0);
+        CHECK(!games["4"].failed && games["4"].data.ccu == 12);
+        auto validation = fetcher.fetchGames({"1", "4"});
+        CHECK(validation["1"].failed && validation["1"].info.name == "One");
+    }
+
+    // One failed votes response between good ones: the rating figures and
+    // vote intervals never see a 0% rating
+    {
+        transport.games = kGames;
+        SeriesStats stats;
+        SlidingWindows windows({15 * 60000LL});
+        for (int minute = 0; minute < 5; minute++) {
+            transport.votes = minute == 2 ? "" : kVotes;
+            GameSnapshot snapshot = fetcher.fetch({"1"}, false)["1"];
+            snapshot.data.timestampMs = 1760000000000LL + minute * 60000LL;
+            stats.add(snapshot.data, minute, snapshot.hasVotes);
+            windows.add(snapshot.data, snapshot.hasVotes);
+        }
+        CHECK(stats.ccu.count == 5);
+        CHECK(stats.rating.count == 4);
+        CHECK(stats.rating.min == 90.0 && stats.rating.max == 90.0);
+        CHECK(stats.votes.samples == 4);
+        CHECK(stats.votes.latest.upDelta == 0 && stats.votes.latest.spanMs == 60000);
+        SlidingWindows::Summary window = windows.summary(0);
+        CHECK(window.count == 5 && window.ratingCount == 4);
+        CHECK(window.minRating == 90.0 && window.meanRating == 90.0);
+    }
+
+    // A window whose only samples have no votes has no rating figures, and
+    // recovers them once those samples fall out
+    {
+        SlidingWindows windows({2 * 60000LL});
+        const int64_t startMs = 1760000000000LL;
+        windows.add(GameData{startMs, 10, 0, 0}, false);
+        windows.add(GameData{startMs + 60000, 12, 0, 0}, false);
+        CHECK(windows.summary(0).ratingCount == 0 && windows.summary(0).minRating == 0.0);
+        windows.add(GameData{startMs + 120000, 11, 3, 1}, true);
+        windows.add(GameData{startMs + 180000, 9, 0, 0}, false);
+        windows.add(GameData{startMs + 240000, 9, 0, 0}, false);
+        SlidingWindows::Summary window = windows.summary(0);
+        CHECK(window.count == 2 && window.ratingCount == 0);
+        windows.add(GameData{startMs + 300000, 9, 1, 1}, true);
+        window = windows.summary(0);
+        CHECK(window.ratingCount == 1 && window.minRating == 50.0 && window.maxRating == 50.0);
+    }
+
+    return testResult("test_batch_fetcher");
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+// Minimal checks for the test programs (src/test_*.cpp): CHECK reports a
+// failed condition and carries on, testResult() is the exit code
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition)                                                                  \
+    do {                                                                                  \
+        if (!(condition)) {                                                               \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #condition "\n"; \
+            testFailures()++;                                                             \
+        }                                                                                 \
+    } while (0)
+
+inline int testResult(const char* name) {
+    if (testFailures() == 0) {
+        std::cout << name << ": all checks passed" << std::endl;
+        return 0;
+    }
+    std::cout << name << ": " << testFailures() << " check(s) failed" << std::endl;
+    return 1;
+}
+
+// Whole file as bytes, "" if it cannot be read
+inline std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+inline void writeFile(const std::string& path, const std::string& bytes) {
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), (std::streamsize)bytes.size());
+}
+
+// Empty directory under the system temp directory for one test program,
+// removed again when it goes out of scope
+struct TempDirectory {
+    std::filesystem::path path;
+
+    explicit TempDirectory(const std::string& name) : path(std::filesystem::temp_directory_path() / name) {
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path);
+    }
+    ~TempDirectory() {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+    TempDirectory(const TempDirectory&) = delete;
+    TempDirectory& operator=(const TempDirectory&) = delete;
+
+    std::string file(const std::string& name) const { return (path / name).string(); }
+};
@@ -0,0 +1,156 @@
+// Delta correlation: every pair and lag matches a brute-force Pearson over
+// the points both games have, with scattered gaps, gap runs, leading gaps
+// and a flat game in the table
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "correlation.hpp"
+#include "test_check.hpp"
+
+const float kGap = std::numeric_limits<float>::quiet_NaN();
+
+// Pearson of a's deltas at i against b's at i + lag, skipping the points
+// where either has a gap; NaN if it would not be scored
+double brutePearson(const std::vector<float>& a, const std::vector<float>& b, size_t lag, size_t& points) {
+    std::vector<double> x, y;
+    size_t count = a.size() - 1;
+    for (size_t i = 0; i + lag < count; i++) {
+        size_t j = i + lag;
+        if (std::isnan(a[i]) || std::isnan(a[i + 1]) || std::isnan(b[j]) || std::isnan(b[j + 1])) continue;
+        x.push_back((double)a[i + 1] - a[i]);
+        y.push_back((double)b[j + 1] - b[j]);
+    }
+    points = x.size();
+    if (points < PairCorrelation::kMinPoints) return NAN;
+    double meanX = 0, meanY = 0;
+    for (size_t i = 0; i < points; i++) {
+        meanX += x[i];
+        meanY += y[i];
+    }
+    meanX /= points;
+    meanY /= points;
+    double xy = 0, xx = 0, yy = 0;
+    for (size_t i = 0; i < points; i++) {
+        xy += (x[i] - meanX) * (y[i] - meanY);
+        xx += (x[i] - meanX) * (x[i] - meanX);
+        yy += (y[i] - meanY) * (y[i] - meanY);
+    }
+    if (xx <= 0 || yy <= 0) return NAN;
+    return xy / std::sqrt(xx * yy);
+}
+
+// Games following one shared driver, game g g % 7 steps late and every
+// third one inverted, plus their own noise
+AlignedTable drivenTable(size_t games, size_t points) {
+    std::mt19937 rng(1);
+    std::normal_distribution<double> normal;
+    AlignedTable table;
+    table.grid.size = points;
+    table.columns.resize(games);
+    std::vector<double> driver(points + 100);
+    for (auto& d : driver) d = normal(rng) * 50;
+    for (size_t g = 0; g < games; g++) {
+        double level = 10000 + g * 100;
+        double sign = g % 3 == 0 ? -1 : 1;
+        for (size_t i = 0; i < points; i++) {
+            level += sign * driver[i + 100 - g % 7] + normal(rng) * 40;
+            table.columns[g].push_back((float)level);
+        }
+        auto& column = table.columns[g];
+        if (g % 4 == 1) // scattered failed ticks
+            for (size_t i = 0; i < points; i++)
+                if (rng() % 50 == 0) column[i] = kGap;
+        if (g % 5 == 2) // the monitor not running
+            for (size_t i = points / 3; i < points / 2; i++) column[i] = kGap;
+        if (g % 6 == 3) // added to the watchlist late
+            for (size_t i = 0; i < 7; i++) column[i] = kGap;
+        if (g == 5) // never moves
+            for (auto& value : column) value = 777;
+    }
+    return table;
+}
+
+int main() {
+    const size_t kGames = 24, kPoints = 2000, kMaxLag = 10;
+    AlignedTable table = drivenTable(kGames, kPoints);
+    CorrelationMatrix matrix = correlateDeltas(table, kMaxLag, 4);
+    CHECK(matrix.size() == kGames);
+    CHECK(matrix.pairCount() == kGames * (kGames - 1) / 2);
+
+    double worst = 0;
+    size_t scored = 0;
+    for (size_t a = 0; a < kGames; a++) {
+        for (size_t b = a + 1; b < kGames; b++) {
+            PairCorrelation pair = matrix.at(a, b);
+            size_t points;
+            double same = brutePearson(table.columns[a], table.columns[b], 0, points);
+            CHECK(std::isnan(same) == !pair.scored());
+            if (std::isnan(same)) continue;
+            scored++;
+            CHECK(pair.points == points);
+            worst = std::max(worst, std::fabs(same - pair.correlation));
+
+            double best = same;
+            int bestLag = 0;
+            for (size_t lag = 1; lag <= kMaxLag; lag++) {
+                double ahead = brutePearson(table.columns[a], table.columns[b], lag, points);
+                if (std::fabs(ahead) > std::fabs(best)) {
+                    best = ahead;
+                    bestLag = (int)lag;
+                }
+                double behind = brutePearson(table.columns[b], table.columns[a], lag, points);
+                if (std::fabs(behind) > std::fabs(best)) {
+                    best = behind;
+                    bestLag = -(int)lag;
+                }
+            }
+            worst = std::max(worst, std::fabs(best - pair.lagged));
+            // Two lags this close are a tie either way may win
+            CHECK(pair.lagSteps == bestLag || std::fabs(std::fabs(best) - std::fabs(pair.lagged)) < 1e-4);
+
+            PairCorrelation mirrored = matrix.at(b, a);
+            CHECK(mirrored.lagSteps == -pair.lagSteps && mirrored.correlation == pair.correlation);
+        }
+    }
+    CHECK(worst < 1e-5);
+
+    // The flat game is never scored
+    for (size_t g = 0; g < kGames; g++)
+        if (g != 5) CHECK(!matrix.at(5, g).scored());
+    CHECK(scored == (kGames - 1) * (kGames - 2) / 2);
+
+    // The planted lead shows: game 4 follows game 0 four steps later
+    CHECK(matrix.at(0, 4).lagSteps == 4 && matrix.at(0, 4).hasLead());
+    CHECK(matrix.at(4, 0).lagSteps == -4);
+    CHECK(matrix.at(3, 10).lagSteps == 0 && matrix.at(3, 10).correlation < -0.5f); // both 3 steps late, one inverted
+
+    // The thread count does not change the result
+    CorrelationMatrix single = correlateDeltas(table, kMaxLag, 1);
+    bool same = true;
+    for (size_t a = 0; a < kGames; a++)
+        for (size_t b = a + 1; b < kGames; b++) {
+            PairCorrelation x = matrix.at(a, b), y = single.at(a, b);
+            if (x.scored() != y.scored() || x.lagSteps != y.lagSteps || x.points != y.points ||
+                (x.scored() && (x.correlation != y.correlation || x.lagged != y.lagged))) {
+                same = false;
+            }
+        }
+    CHECK(same);
+
+    // Too few common points: not scored
+    {
+        AlignedTable small = drivenTable(2, kPoints);
+        for (size_t i = 20; i < kPoints; i++) small.columns[1][i] = kGap;
+        CHECK(!correlateDeltas(small, kMaxLag).at(0, 1).scored());
+    }
+    // Nothing to pair
+    {
+        AlignedTable one = drivenTable(1, kPoints);
+        CHECK(correlateDeltas(one, kMaxLag).pairCount() == 0);
+        AlignedTable empty = drivenTable(3, 1);
+        CHECK(!correlateDeltas(empty, kMaxLag).at(0, 1).scored());
+    }
+
+    return testResult("test_correlation");
+}
@@ -0,0 +1,76 @@
+// Drop detector: failed fetches raise nothing, real drops still do
+#include <cstdint>
+#include "drop_detector.hpp"
+#include "test_check.hpp"
+
+const int64_t kStartMs = 1760000000000LL;
+
+// Minute samples around 10000 CCU with a little deterministic noise
+GameSnapshot steady(int minute) {
+    GameSnapshot snapshot;
+    snapshot.data = GameData{kStartMs + minute * 60000LL, (uint32_t)(10000 + (minute * 37) % 41 - 20), 500, 50};
+    return snapshot;
+}
+
+// Events of a detector fed 60 steady minutes with sample at minute 30
+int eventsWith(const GameSnapshot& sample, DropDetector& detector) {
+    int events = 0;
+    for (int minute = 0; minute < 60; minute++) {
+        DropDetector::Event event = detector.add(minute == 30 ? sample : steady(minute));
+        if (event != DropDetector::kNone) events++;
+    }
+    return events;
+}
+
+int main() {
+    // A lone failed fetch: no alert, no drop in the results
+    {
+        DropDetector detector;
+        CHECK(eventsWith(GameSnapshot::failedAt(kStartMs + 30 * 60000LL), detector) == 0);
+        CHECK(detector.getDropCount() == 0);
+        CHECK(detector.largestDrop() == nullptr);
+        CHECK(!detector.inDrop());
+    }
+    // Several failed fetches in a row change nothing either
+    {
+        DropDetector detector;
+        int events = 0;
+        for (int minute = 0; minute < 60; minute++) {
+            GameSnapshot sample = minute >= 30 && minute < 35 ? GameSnapshot::failedAt(kStartMs + minute * 60000LL)
+                                                              : steady(minute);
+            if (detector.add(sample) != DropDetector::kNone) events++;
+        }
+        CHECK(events == 0);
+        CHECK(detector.getDropCount() == 0);
+    }
+    // The same zero as a real sample is a drop (a game that emptied)
+    {
+        DropDetector detector;
+        GameSnapshot empty;
+        empty.data = GameData{kStartMs + 30 * 60000LL, 0, 500, 50};
+        CHECK(eventsWith(empty, detector) == 2); // started, then ended
+        CHECK(detector.getDropCount() == 1);
+        CHECK(detector.largestDrop() && detector.largestDrop()->lowCcu == 0);
+    }
+    // A real 30% drop is flagged on its first sample
+    {
+        DropDetector detector;
+        DropDetector::Event first = DropDetector::kNone;
+        for (int minute = 0; minute < 40 && first == DropDetector::kNone; minute++) {
+            GameSnapshot sample = steady(minute);
+            if (minute >= 30) sample.data.ccu = sample.data.ccu * 7 / 10;
+            first = detector.add(sample);
+            if (first != DropDetector::kNone) CHECK(minute == 30);
+        }
+        CHECK(first == DropDetector::kDropStarted);
+    }
+    // Steady data raises nothing
+    {
+        DropDetector detector;
+        int events = 0;
+        for (int minute = 0; minute < 1000; minute++)
+            if (detector.add(steady(minute)) != DropDetector::kNone) events++;
+        CHECK(events == 0);
+    }
+    return testResult("test_drop_detector");
+}
@@ -0,0 +1,120 @@
+// Game info cache: entries survive save and reload, expire on time, and a
+// torn last entry is dropped while the entries before it survive
+#include <cstdint>
+#include <string>
+#include "game_info_cache.hpp"
+#include "test_check.hpp"
+
+const int64_t kNowMs = 1760000000000LL;
+const int64_t kDayMs = 24LL * 60 * 60 * 1000;
+
+GameInfo infoFor(int n) {
+    GameInfo info;
+    info.name = "Game " + std::to_string(n);
+    info.description = std::string(100 * n, 'd');
+    info.created = "2020-01-0" + std::to_string(n % 10);
+    info.creatorName = n % 2 ? "" : "creator";
+    info.creatorType = n % 2 ? "Group" : "User";
+    info.maxPlayers = 10 * n;
+    return info;
+}
+
+bool sameInfo(const GameInfo& a, const GameInfo& b) {
+    return a.name == b.name && a.description == b.description && a.created == b.created &&
+           a.creatorName == b.creatorName && a.creatorType == b.creatorType && a.maxPlayers == b.maxPlayers;
+}
+
+bool hasInfo(const GameInfoCache& cache, int n, int64_t nowMs = kNowMs) {
+    GameInfo info;
+    return cache.lookup(std::to_string(n), info, nowMs) == GameInfoCache::kValid && sameInfo(info, infoFor(n));
+}
+
+GameInfoCache::Lookup lookupOf(const GameInfoCache& cache, int n, int64_t nowMs = kNowMs) {
+    GameInfo info;
+    return cache.lookup(std::to_string(n), info, nowMs);
+}
+
+int main() {
+    TempDirectory temp("robloxmonitor_test_cache");
+    const std::string path = temp.file("game_info_cache.bin");
+
+    // Valid and negative entries, put out of order, in two saves
+    {
+        GameInfoCache cache(path);
+        CHECK(cache.size() == 0);
+        CHECK(lookupOf(cache, 1) == GameInfoCache::kMiss);
+        cache.put("3", infoFor(3), kNowMs);
+        cache.put("1", infoFor(1), kNowMs);
+        cache.putInvalid("2", kNowMs);
+        CHECK(hasInfo(cache, 1) && hasInfo(cache, 3)); // before saving too
+        CHECK(cache.save(kNowMs));
+        CHECK(!cache.hasChanges());
+        cache.put("5", infoFor(5), kNowMs);
+        cache.put("4", infoFor(4), kNowMs);
+        CHECK(cache.save(kNowMs));
+        CHECK(cache.size() == 5);
+    }
+    {
+        GameInfoCache cache(path);
+        CHECK(cache.size() == 5);
+        CHECK(hasInfo(cache, 1) && hasInfo(cache, 3) && hasInfo(cache, 4) && hasInfo(cache, 5));
+        CHECK(lookupOf(cache, 2) == GameInfoCache::kInvalid);
+        CHECK(lookupOf(cache, 6) == GameInfoCache::kMiss);
+        // Negative entries expire after a day, valid ones after a week
+        CHECK(lookupOf(cache, 2, kNowMs + 2 * kDayMs) == GameInfoCache::kMiss);
+        CHECK(hasInfo(cache, 1, kNowMs + 6 * kDayMs));
+        CHECK(lookupOf(cache, 1, kNowMs + 8 * kDayMs) == GameInfoCache::kMiss);
+        // Replacing an entry keeps one entry for the ID
+        cache.put("2", infoFor(2), kNowMs);
+        CHECK(cache.save(kNowMs));
+        CHECK(cache.size() == 5);
+        CHECK(hasInfo(cache, 2));
+    }
+
+    // Torn in the last entry's strings: that entry misses, the ones before
+    // it survive, and the next save leaves it out
+    std::string intact = readFile(path);
+    writeFile(path, intact.substr(0, intact.size() - 7));
+    {
+        GameInfoCache cache(path);
+        CHECK(cache.size() == 5);
+        CHECK(hasInfo(cache, 1) && hasInfo(cache, 2) && hasInfo(cache, 3) && hasInfo(cache, 4));
+        CHECK(lookupOf(cache, 5) == GameInfoCache::kMiss);
+        cache.put("6", infoFor(6), kNowMs);
+        CHECK(cache.save(kNowMs));
+        CHECK(cache.size() == 5);
+    }
+    {
+        GameInfoCache cache(path);
+        CHECK(cache.size() == 5);
+        CHECK(hasInfo(cache, 1) && hasInfo(cache, 2) && hasInfo(cache, 3) && hasInfo(cache, 4) && hasInfo(cache, 6));
+        CHECK(lookupOf(cache, 5) == GameInfoCache::kMiss);
+    }
+
+    // Torn in the index: an empty cache that saves cleanly again
+    intact = readFile(path);
+    writeFile(path, intact.substr(0, 16 + 32 * 2 + 5));
+    {
+        GameInfoCache cache(path);
+        CHECK(cache.size() == 0);
+        CHECK(lookupOf(cache, 1) == GameInfoCache::kMiss);
+        cache.put("7", infoFor(7), kNowMs);
+        CHECK(cache.save(kNowMs));
+    }
+    {
+        GameInfoCache cache(path);
+        CHECK(cache.size() == 1);
+        CHECK(hasInfo(cache, 7));
+    }
+
+    // Expired entries are dropped when saving
+    {
+        GameInfoCache cache(path);
+        cache.putInvalid("8", kNowMs);
+        CHECK(cache.save(kNowMs + 2 * kDayMs));
+        CHECK(cache.size() == 1);
+        CHECK(hasInfo(cache, 7));
+    }
+
+    return testResult("test_game_info_cache");
+}
@@ -0,0 +1,143 @@
+// Gorilla block codec: every block decodes back to exactly what was encoded
+#include <climits>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "gorilla_codec.hpp"
+#include "sample_store.hpp"
+#include "test_check.hpp"
+
+const int64_t kMinuteMs = 60000;
+
+bool sameSamples(const std::vector<GameData>& a, const std::vector<GameData>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].timestampMs != b[i].timestampMs || a[i].ccu != b[i].ccu || a[i].upVotes != b[i].upVotes ||
+            a[i].downVotes != b[i].downVotes)
+            return false;
+    }
+    return true;
+}
+
+// Encodes samples as one block and decodes it again
+std::vector<GameData> roundTrip(const std::vector<GameData>& samples, size_t* bytes = nullptr) {
+    GorillaEncoder encoder;
+    for (const auto& sample : samples) encoder.add(sample);
+    std::vector<GameData> decoded;
+    bool ok = decodeGorillaBlock(encoder.data().data(), encoder.data().size(), encoder.size(), decoded);
+    CHECK(ok);
+    if (bytes) *bytes = encoder.data().size();
+    return decoded;
+}
+
+// Minute samples like the monitor takes them: steady ticks, small CCU
+// moves, a vote now and then
+std::vector<GameData> minuteSeries(size_t count, std::mt19937_64& rng) {
+    std::vector<GameData> samples;
+    GameData sample{1760000000000LL, 50000, 90000, 10000};
+    for (size_t i = 0; i < count; i++) {
+        sample.timestampMs += kMinuteMs;
+        sample.ccu += (int)(rng() % 201) - 100;
+        if (rng() % 4 == 0) sample.upVotes += rng() % 3;
+        if (rng() % 20 == 0) sample.downVotes++;
+        samples.push_back(sample);
+    }
+    return samples;
+}
+
+int main() {
+    std::mt19937_64 rng(1);
+
+    // A full archive block of minute samples, and how small it gets: 24
+    // bytes each raw, about 2.3 encoded
+    {
+        std::vector<GameData> samples = minuteSeries(SampleStore::kBlockSamples, rng);
+        size_t bytes = 0;
+        CHECK(sameSamples(roundTrip(samples, &bytes), samples));
+        CHECK((double)bytes / samples.size() < 3.0);
+    }
+    // One sample, and two
+    {
+        std::vector<GameData> one = {GameData{1760000000000LL, 7, 8, 9}};
+        CHECK(sameSamples(roundTrip(one), one));
+        std::vector<GameData> two = {one[0], GameData{1760000060000LL, 0, 0, 0}};
+        CHECK(sameSamples(roundTrip(two), two));
+    }
+    // Irregular timestamps: delta-of-deltas on both sides of every bucket
+    // edge, repeated and backwards steps, gaps of days, jitter
+    {
+        std::vector<GameData> samples;
+        GameData sample{1760000000000LL, 100, 10, 1};
+        auto step = [&](int64_t ms) {
+            sample.timestampMs += ms;
+            samples.push_back(sample);
+        };
+        step(kMinuteMs);
+        const int64_t edges[] = {63, 64, -64, -65, 2047, 2048, -2048, -2049, 524287, 524288, -524288, -524289};
+        for (int64_t edge : edges) {
+            step(kMinuteMs + edge); // delta-of-delta edge
+            step(kMinuteMs);        // and -edge
+        }
+        const int64_t steps[] = {0, 0, -1, -kMinuteMs, 3 * 86400000LL, 1, 15000};
+        for (int64_t ms : steps) step(ms);
+        for (int i = 0; i < 500; i++) step(15000 + (int64_t)(rng() % 400) - 200);
+        CHECK(sameSamples(roundTrip(samples), samples));
+    }
+    // Timestamps far apart and below zero (the 64-bit bucket)
+    {
+        std::vector<GameData> samples = {GameData{-5, 1, 1, 1}, GameData{INT64_MAX / 4, 2, 2, 2},
+                                         GameData{INT64_MIN / 4, 3, 3, 3}, GameData{0, 4, 4, 4}};
+        CHECK(sameSamples(roundTrip(samples), samples));
+    }
+    // CCU and vote jumps beyond 2^31 either way, up to the full range
+    {
+        std::vector<GameData> samples;
+        int64_t time = 1760000000000LL;
+        const uint32_t values[] = {0, 3000000000u, 1, UINT32_MAX, 0, 2147483648u, 2147483647u, UINT32_MAX, 5};
+        for (uint32_t value : values) {
+            time += kMinuteMs;
+            samples.push_back(GameData{time, value, UINT32_MAX - value, value / 3});
+        }
+        CHECK(sameSamples(roundTrip(samples), samples));
+    }
+    // Random blocks of every length up to a full block
+    {
+        bool allSame = true;
+        for (uint32_t count = 1; count <= SampleStore::kBlockSamples; count++) {
+            std::vector<GameData> samples;
+            GameData sample{(int64_t)(rng() >> 20), (uint32_t)rng(), (uint32_t)rng(), (uint32_t)rng()};
+            for (uint32_t i = 0; i < count; i++) {
+                sample.timestampMs += (int64_t)(rng() % 120000) - 30000;
+                sample.ccu = rng() % 3 == 0 ? (uint32_t)rng() : sample.ccu + (uint32_t)(rng() % 50);
+                sample.upVotes += (uint32_t)(rng() % 5);
+                sample.downVotes = (uint32_t)rng();
+                samples.push_back(sample);
+            }
+            allSame = allSame && sameSamples(roundTrip(samples), samples);
+        }
+        CHECK(allSame);
+    }
+    // The encoder starts over cleanly after clear()
+    {
+        GorillaEncoder encoder;
+        std::vector<GameData> first = minuteSeries(10, rng), second = minuteSeries(20, rng);
+        for (const auto& sample : first) encoder.add(sample);
+        encoder.clear();
+        for (const auto& sample : second) encoder.add(sample);
+        std::vector<GameData> decoded;
+        CHECK(decodeGorillaBlock(encoder.data().data(), encoder.data().size(), encoder.size(), decoded));
+        CHECK(sameSamples(decoded, second));
+    }
+    // A truncated block fails and keeps the samples before the cut
+    {
+        std::vector<GameData> samples = minuteSeries(SampleStore::kBlockSamples, rng);
+        GorillaEncoder encoder;
+        for (const auto& sample : samples) encoder.add(sample);
+        std::vector<GameData> decoded;
+        CHECK(!decodeGorillaBlock(encoder.data().data(), encoder.data().size() / 2, encoder.size(), decoded));
+        CHECK(!decoded.empty() && decoded.size() < samples.size());
+        decoded.resize(std::min(decoded.size(), samples.size()));
+        CHECK(sameSamples(decoded, std::vector<GameData>(samples.begin(), samples.begin() + decoded.size())));
+    }
+    return testResult("test_gorilla_codec");
+}
@@ -0,0 +1,207 @@
+// Session journal: a checkpoint plus logged ticks recover as written, a torn
+// or damaged last record is dropped and the records before it survive
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "session_journal.hpp"
+#include "test_check.hpp"
+
+const int64_t kStartMs = 1760000000000LL;
+const int64_t kMinuteMs = 60000;
+
+SessionJournal::Config testConfig() {
+    SessionJournal::Config config;
+    config.watchlistMode = true;
+    config.countUpdates = true;
+    config.duration = 90;
+    config.startedMs = kStartMs;
+    config.ids = {"1818", "920587237", "", "4924922222"};
+    return config;
+}
+
+// One tick of the watchlist, with counts past 2^31, a game whose fetch
+// failed and one whose votes did not arrive; tick 3 has no entries
+std::vector<SessionJournal::Entry> tickEntries(int tick) {
+    std::vector<SessionJournal::Entry> entries;
+    if (tick == 3) return entries;
+    for (uint32_t index = 0; index < 4; index++) {
+        int64_t timestampMs = kStartMs + tick * kMinuteMs;
+        if (index == 2) {
+            entries.push_back(SessionJournal::Entry::from(index, GameSnapshot::failedAt(timestampMs)));
+            continue;
+        }
+        GameSnapshot snapshot;
+        snapshot.data = GameData{timestampMs, 3000000000u + index * 1000 + tick, 7, 4000000000u};
+        snapshot.visits = 9000000000LL + tick;
+        snapshot.favoritedCount = 123456 + tick;
+        snapshot.hasVotes = index != 3;
+        if (!snapshot.hasVotes) snapshot.data.upVotes = snapshot.data.downVotes = 0;
+        entries.push_back(SessionJournal::Entry::from(index, snapshot));
+    }
+    return entries;
+}
+
+bool sameEntries(const std::vector<SessionJournal::Entry>& a, const std::vector<SessionJournal::Entry>& b) {
+    return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(a[0])) == 0);
+}
+
+// Ticks recovered are ticks first..first+count-1, in order
+bool hasTicks(const SessionJournal::Recovered& recovered, int first, int count) {
+    if (recovered.ticks.size() != (size_t)count) return false;
+    for (int i = 0; i < count; i++) {
+        const SessionJournal::Tick& tick = recovered.ticks[i];
+        if (tick.nextTickMs != kStartMs + (first + i + 1) * kMinuteMs) return false;
+        if (!sameEntries(tick.entries, tickEntries(first + i))) return false;
+    }
+    return true;
+}
+
+void appendTicks(SessionJournal& journal, int first, int count) {
+    for (int tick = first; tick < first + count; tick++)
+        CHECK(journal.append(kStartMs + (tick + 1) * kMinuteMs, tickEntries(tick)));
+}
+
+int main() {
+    TempDirectory temp("robloxmonitor_test_journal");
+    const std::string directory = temp.path.string();
+
+    SessionJournal::Config config = testConfig();
+    std::vector<MonitorState> states(config.ids.size());
+    std::vector<TDigest> digests(config.ids.size());
+    for (size_t g = 0; g < states.size(); g++) {
+        for (int minute = 0; minute < 200; minute++) {
+            GameData data{kStartMs + minute * kMinuteMs, (uint32_t)(1000 * (g + 1) + minute % 17), 90, 10};
+            states[g].stats.add(data, states[g].totalCount++);
+            states[g].drops.add(data);
+            digests[g].add(data.ccu);
+        }
+        states[g].firstVisits = 100 + (int64_t)g;
+        states[g].lastVisits = 5000000000LL;
+        states[g].missedCount = g;
+    }
+    std::vector<const TDigest*> digestPointers;
+    for (const auto& digest : digests) digestPointers.push_back(&digest);
+
+    // Checkpoint and log, then recover everything as written
+    {
+        SessionJournal journal(directory);
+        CHECK(!journal.hasUnfinished());
+        journal.begin(config);
+        CHECK(journal.checkpoint(kStartMs, states, digestPointers));
+        CHECK(journal.hasUnfinished());
+        appendTicks(journal, 0, 5);
+    }
+    SessionJournal::Recovered recovered;
+    {
+        SessionJournal journal(directory);
+        CHECK(journal.recover(recovered));
+        CHECK(recovered.config.watchlistMode && recovered.config.countUpdates);
+        CHECK(recovered.config.duration == config.duration && recovered.config.startedMs == config.startedMs);
+        CHECK(recovered.config.ids == config.ids);
+        CHECK(recovered.states.size() == states.size());
+        CHECK(recovered.states.size() == states.size() &&
+              std::memcmp(recovered.states.data(), states.data(), states.size() * sizeof(MonitorState)) == 0);
+        CHECK(recovered.digests.size() == digests.size());
+        for (size_t g = 0; g < digests.size() && g < recovered.digests.size(); g++) {
+            std::string written, read;
+            digests[g].serialize(written);
+            recovered.digests[g].serialize(read);
+            CHECK(written == read);
+        }
+        CHECK(hasTicks(recovered, 0, 5));
+        CHECK(recovered.lastSeq == 5);
+        // Logged ticks come back as the snapshots they were made from
+        if (recovered.ticks.size() == 5 && recovered.ticks[0].entries.size() == 4) {
+            const auto& entries = recovered.ticks[0].entries;
+            GameSnapshot sample = entries[0].toSnapshot();
+            CHECK(!sample.failed && sample.hasVotes && sample.data.ccu == 3000000000u);
+            CHECK(sample.data.downVotes == 4000000000u && sample.visits == 9000000000LL);
+            GameSnapshot missed = entries[2].toSnapshot();
+            CHECK(missed.failed && missed.data.timestampMs == kStartMs && missed.data.ccu == 0);
+            GameSnapshot noVotes = entries[3].toSnapshot();
+            CHECK(!noVotes.failed && !noVotes.hasVotes && noVotes.data.ccu == 3000003000u);
+        }
+        // A tick without entries still moves the next tick time on
+        CHECK(recovered.ticks.size() == 5 && recovered.ticks[3].entries.empty() &&
+              recovered.ticks[3].nextTickMs == kStartMs + 4 * kMinuteMs);
+        CHECK(recovered.nextTickMs == kStartMs + 5 * kMinuteMs);
+        CHECK(recovered.logBytes == std::filesystem::file_size(journal.logPath()));
+    }
+
+    // A torn last record (the process died mid-write) is dropped, the four
+    // before it survive; resuming cuts it off and logs after them
+    {
+        SessionJournal journal(directory);
+        std::string log = readFile(journal.logPath());
+        writeFile(journal.logPath(), log.substr(0, log.size() - 13));
+        SessionJournal::Recovered torn;
+        CHECK(journal.recover(torn));
+        CHECK(hasTicks(torn, 0, 4));
+        CHECK(torn.lastSeq == 4);
+        CHECK(torn.nextTickMs == kStartMs + 4 * kMinuteMs);
+        CHECK(torn.logBytes < log.size() - 13);
+
+        journal.resume(torn);
+        CHECK(std::filesystem::file_size(journal.logPath()) == torn.logBytes);
+        appendTicks(journal, 4, 3);
+    }
+    {
+        SessionJournal journal(directory);
+        SessionJournal::Recovered resumed;
+        CHECK(journal.recover(resumed));
+        CHECK(hasTicks(resumed, 0, 7));
+        CHECK(resumed.lastSeq == 7);
+    }
+
+    // A damaged last record is dropped the same way
+    {
+        SessionJournal journal(directory);
+        std::string log = readFile(journal.logPath());
+        log[log.size() - 5] ^= 0x40;
+        writeFile(journal.logPath(), log);
+        SessionJournal::Recovered damaged;
+        CHECK(journal.recover(damaged));
+        CHECK(hasTicks(damaged, 0, 6));
+        CHECK(damaged.lastSeq == 6);
+    }
+
+    // Records the checkpoint already covers are skipped: a crash between
+    // writing the checkpoint and emptying the log replays nothing twice
+    {
+        SessionJournal journal(directory);
+        journal.begin(config);
+        CHECK(journal.checkpoint(kStartMs, states, digestPointers));
+        appendTicks(journal, 0, 3);
+        std::string log = readFile(journal.logPath());
+        CHECK(journal.checkpoint(kStartMs + 3 * kMinuteMs, states, digestPointers));
+        CHECK(std::filesystem::file_size(journal.logPath()) == 0);
+        writeFile(journal.logPath(), log);
+        SessionJournal::Recovered stale;
+        CHECK(journal.recover(stale));
+        CHECK(stale.ticks.empty());
+        CHECK(stale.lastSeq == 3);
+        CHECK(stale.nextTickMs == kStartMs + 3 * kMinuteMs);
+    }
+
+    // A damaged checkpoint is not resumed at all
+    {
+        SessionJournal journal(directory);
+        std::string checkpoint = readFile(journal.checkpointPath());
+        checkpoint[checkpoint.size() / 2] ^= 0x01;
+        writeFile(journal.checkpointPath(), checkpoint);
+        SessionJournal::Recovered broken;
+        CHECK(!journal.recover(broken));
+    }
+
+    // Finishing removes both files
+    {
+        SessionJournal journal(directory);
+        journal.finish();
+        CHECK(!journal.hasUnfinished());
+        CHECK(!std::filesystem::exists(journal.logPath()));
+    }
+
+    return testResult("test_session_journal");
+}
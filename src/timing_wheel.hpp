@@ -0,0 +1,119 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Hashed hierarchical timing wheel over steady_clock deadlines.
+// Four levels of 256 slots: level 0 holds timers due within 256 ticks,
+// each higher level covers 256 times the span of the one below and is
+// cascaded down when the lower level wraps. Scheduling and firing are
+// O(1) per timer, so tens of thousands of per-universe timers
+// cost no more than a handful.
+class TimingWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+
+    static constexpr unsigned kSlotBits = 8;
+    static constexpr size_t kSlots = size_t(1) << kSlotBits;
+    static constexpr unsigned kLevels = 4;
+
+    explicit TimingWheel(std::chrono::milliseconds resolution = std::chrono::milliseconds(10),
+                         Clock::time_point origin = Clock::now())
+        : resolution(resolution), origin(origin) {}
+
+    // Fires fn at the first advance() at or after deadline
+    void schedule(Clock::time_point deadline, Callback fn) {
+        place(Entry{toTick(deadline), std::move(fn)});
+        count++;
+    }
+
+    // Fires every timer due at or before now
+    void advance(Clock::time_point now) {
+        if (now < origin) return;
+        uint64_t target = (uint64_t)((now - origin) / resolution);
+        while (currentTick <= target) {
+            if (currentTick != 0 && (currentTick & (kSlots - 1)) == 0) cascade();
+
+            // Callbacks may schedule timers due on this same tick, so keep
+            // draining the slot until it stays empty
+            std::vector<Entry>& slot = slots[0][currentTick & (kSlots - 1)];
+            while (!slot.empty()) {
+                std::vector<Entry> due;
+                due.swap(slot);
+                for (auto& entry : due) {
+                    if (entry.expiry > currentTick) { place(std::move(entry)); continue; }
+                    count--;
+                    entry.fn();
+                }
+            }
+            currentTick++;
+        }
+    }
+
+    // Earliest time advance() may have work: the next non-empty level 0
+    // slot, or the next cascade point, whichever comes first. currentTick
+    // itself has not been processed yet, so it may be a pending cascade.
+    Clock::time_point nextWakeup() const {
+        for (uint64_t tick = currentTick; tick < currentTick + kSlots; tick++) {
+            if (tick != 0 && (tick & (kSlots - 1)) == 0) return toTime(tick);
+            if (!slots[0][tick & (kSlots - 1)].empty()) return toTime(tick);
+        }
+        return toTime(currentTick + kSlots);
+    }
+
+    // Pending timers
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+private:
+    struct Entry {
+        uint64_t expiry; // tick
+        Callback fn;
+    };
+
+    std::chrono::milliseconds resolution;
+    Clock::time_point origin;
+    uint64_t currentTick = 0; // ticks before this one have been processed
+    size_t count = 0;
+    std::vector<Entry> slots[kLevels][kSlots];
+
+    uint64_t toTick(Clock::time_point deadline) const {
+        if (deadline <= origin) return 0;
+        auto ticks = (deadline - origin + resolution - Clock::duration(1)) / resolution; // round up
+        return (uint64_t)ticks;
+    }
+
+    Clock::time_point toTime(uint64_t tick) const {
+        return origin + resolution * (int64_t)tick;
+    }
+
+    void place(Entry&& entry) {
+        if (entry.expiry < currentTick) entry.expiry = currentTick;
+        uint64_t delta = entry.expiry - currentTick;
+        unsigned level = 0;
+        while (level + 1 < kLevels && delta >= (uint64_t(1) << (kSlotBits * (level + 1)))) level++;
+        uint64_t maxDelta = (uint64_t(1) << (kSlotBits * kLevels)) - 1;
+        if (delta > maxDelta) entry.expiry = currentTick + maxDelta;
+        size_t index = (entry.expiry >> (kSlotBits * level)) & (kSlots - 1);
+        slots[level][index].push_back(std::move(entry));
+    }
+
+    // Level 0 wrapped: move the current slot of every level whose lower
+    // levels all wrapped down, highest level first so nothing lands in a
+    // slot that was already emptied on this tick
+    void cascade() {
+        unsigned top = 1;
+        while (top + 1 < kLevels && ((currentTick >> (kSlotBits * top)) & (kSlots - 1)) == 0) top++;
+        for (unsigned level = top; level >= 1; level--) {
+            size_t index = (currentTick >> (kSlotBits * level)) & (kSlots - 1);
+            std::vector<Entry> moving;
+            moving.swap(slots[level][index]);
+            for (auto& entry : moving) place(std::move(entry));
+        }
+    }
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include "game_data.hpp"
+
+// Votes that arrived between two samples of a game. Counts are net: a
+// voter switching from dislike to like shows up as +1 like, -1 dislike.
+struct VoteInterval {
+    int64_t upDelta = 0;
+    int64_t downDelta = 0;
+    int64_t spanMs = 0;
+
+    int64_t votes() const { return upDelta + downDelta; }
+    double perMinute() const { return spanMs > 0 ? votes() * 60000.0 / spanMs : 0.0; }
+
+    // Likes among the new votes in percent; false if no votes were added
+    // on balance (or any were taken away), where a share means nothing
+    bool likeRatio(double& percent) const {
+        if (upDelta < 0 || downDelta < 0 || votes() <= 0) return false;
+        percent = (double)upDelta / votes() * 100.0;
+        return true;
+    }
+};
+
+// Running vote analytics of one game from its raw vote counts, O(1) per
+// sample: the latest interval, the totals since the first sample and the
+// fastest interval. The overall rating of a big game hardly moves in an
+// hour, but the like ratio of the votes that arrived in it does.
+//
+// Samples without any votes are skipped; they come from a failed votes
+// request, not from a game that lost all its votes.
+struct VoteVelocity {
+    uint64_t samples = 0; // with vote counts
+    uint32_t firstUp = 0, firstDown = 0;
+    uint32_t lastUp = 0, lastDown = 0;
+    int64_t firstMs = 0, lastMs = 0;
+    VoteInterval latest;  // between the two latest samples
+    VoteInterval fastest; // highest votes per minute
+    int64_t fastestEndMs = 0;
+
+    void add(const GameData& data) {
+        if (!data.hasVotes()) return;
+        if (samples == 0) {
+            firstUp = data.upVotes;
+            firstDown = data.downVotes;
+            firstMs = data.timestampMs;
+        } else {
+            latest.upDelta = (int64_t)data.upVotes - lastUp;
+            latest.downDelta = (int64_t)data.downVotes - lastDown;
+            latest.spanMs = data.timestampMs - lastMs;
+            if (samples == 1 || latest.perMinute() > fastest.perMinute()) {
+                fastest = latest;
+                fastestEndMs = data.timestampMs;
+            }
+        }
+        lastUp = data.upVotes;
+        lastDown = data.downVotes;
+        lastMs = data.timestampMs;
+        samples++;
+    }
+
+    // At least two samples with votes, so there are intervals
+    bool hasIntervals() const { return samples >= 2; }
+
+    VoteInterval total() const {
+        VoteInterval interval;
+        interval.upDelta = (int64_t)lastUp - firstUp;
+        interval.downDelta = (int64_t)lastDown - firstDown;
+        interval.spanMs = lastMs - firstMs;
+        return interval;
+    }
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// List of universe IDs to monitor, read from a file or command line text.
+// IDs may be separated by whitespace, commas or semicolons; '#' starts a
+// comment that runs to the end of the line. Duplicates are dropped and the
+// first-seen order is kept.
+class Watchlist {
+public:
+    static bool isUniverseId(const std::string& token) {
+        if (token.empty() || token.size() > 19) return false;
+        for (char c : token)
+            if (!std::isdigit((unsigned char)c)) return false;
+        return true;
+    }
+
+    // Adds every ID in text; tokens that are not IDs go to rejected()
+    void add(const std::string& text) {
+        std::istringstream lines(text);
+        std::string line;
+        while (std::getline(lines, line)) {
+            size_t comment = line.find('#');
+            if (comment != std::string::npos) line.erase(comment);
+            for (char& c : line)
+                if (c == ',' || c == ';') c = ' ';
+            std::istringstream tokens(line);
+            std::string token;
+            while (tokens >> token) {
+                if (!isUniverseId(token)) rejectedTokens.push_back(token);
+                else if (seen.insert(token).second) idList.push_back(token);
+            }
+        }
+    }
+
+    // Returns false if the file cannot be read
+    bool loadFile(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) return false;
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        add(contents.str());
+        return true;
+    }
+
+    const std::vector<std::string>& ids() const { return idList; }
+    const std::vector<std::string>& rejected() const { return rejectedTokens; }
+    size_t size() const { return idList.size(); }
+    bool empty() const { return idList.empty(); }
+
+private:
+    std::vector<std::string> idList;
+    std::vector<std::string> rejectedTokens;
+    std::unordered_set<std::string> seen;
+};
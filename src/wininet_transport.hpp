@@ -0,0 +1,143 @@
+#pragma once
+
+#include <iostream>
+#include <algorithm>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <unordered_map>
+#include <windows.h>
+#include <wininet.h>
+#include "http_transport.hpp"
+
+// WinINet backend with a keep-alive connection pool.
+// One internet session is opened for the lifetime of the transport and one
+// connect handle is kept per host, so WinINet can keep the TCP/TLS
+// connections alive between samples instead of handshaking on every request.
+// Shared by all monitors and threads.
+class WinInetTransport : public HttpTransport {
+private:
+    static constexpr DWORD kMaxConnsPerServer = 16;
+
+    HINTERNET hInternet = NULL;
+    std::mutex mtx;
+    std::unordered_map<std::string, HINTERNET> connections; // "host:port" -> connect handle
+
+public:
+    explicit WinInetTransport(DWORD timeoutMs = 10000) {
+        hInternet = InternetOpenA("RobloxMonitor", INTERNET_OPEN_TYPE_DIRECT, NULL, NULL, 0);
+        if (!hInternet) {
+            std::cerr << "InternetOpenA failed. Error: " << GetLastError() << std::endl;
+            return;
+        }
+        // Allow enough parallel keep-alive sockets per host for concurrent requests
+        DWORD maxConns = kMaxConnsPerServer;
+        InternetSetOptionA(hInternet, INTERNET_OPTION_MAX_CONNS_PER_SERVER, &maxConns, sizeof(maxConns));
+        InternetSetOptionA(hInternet, INTERNET_OPTION_CONNECT_TIMEOUT, &timeoutMs, sizeof(timeoutMs));
+        InternetSetOptionA(hInternet, INTERNET_OPTION_SEND_TIMEOUT, &timeoutMs, sizeof(timeoutMs));
+        InternetSetOptionA(hInternet, INTERNET_OPTION_RECEIVE_TIMEOUT, &timeoutMs, sizeof(timeoutMs));
+    }
+
+    ~WinInetTransport() override {
+        for (auto& entry : connections) InternetCloseHandle(entry.second);
+        if (hInternet) InternetCloseHandle(hInternet);
+    }
+
+    WinInetTransport(const WinInetTransport&) = delete;
+    WinInetTransport& operator=(const WinInetTransport&) = delete;
+
+private:
+    // Returns the cached connect handle for host:port, opening it on first use
+    HINTERNET getConnection(const std::string& host, INTERNET_PORT port) {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::string key = host + ":" + std::to_string(port);
+        auto it = connections.find(key);
+        if (it != connections.end()) return it->second;
+
+        HINTERNET hConnect = InternetConnectA(hInternet, host.c_str(), port, NULL, NULL, INTERNET_SERVICE_HTTP, 0, 0);
+        if (!hConnect) {
+            std::cerr << "InternetConnectA failed for host: " << host << " Error: " << GetLastError() << std::endl;
+            return NULL;
+        }
+        connections[key] = hConnect;
+        return hConnect;
+    }
+
+public:
+    std::string get(const std::string& url) override {
+        if (!hInternet) return "";
+
+        char host[256] = {0};
+        char path[2048] = {0};
+        URL_COMPONENTSA parts = {};
+        parts.dwStructSize = sizeof(parts);
+        parts.lpszHostName = host;
+        parts.dwHostNameLength = sizeof(host);
+        parts.lpszUrlPath = path;
+        parts.dwUrlPathLength = sizeof(path);
+        if (!InternetCrackUrlA(url.c_str(), 0, 0, &parts)) {
+            std::cerr << "InternetCrackUrlA failed for URL: " << url << " Error: " << GetLastError() << std::endl;
+            return "";
+        }
+
+        HINTERNET hConnect = getConnection(host, parts.nPort);
+        if (!hConnect) return "";
+
+        DWORD flags = INTERNET_FLAG_RELOAD | INTERNET_FLAG_NO_CACHE_WRITE | INTERNET_FLAG_KEEP_CONNECTION | INTERNET_FLAG_NO_UI;
+        if (parts.nScheme == INTERNET_SCHEME_HTTPS) flags |= INTERNET_FLAG_SECURE;
+
+        HINTERNET hRequest = HttpOpenRequestA(hConnect, "GET", path, NULL, NULL, NULL, flags, 0);
+        if (!hRequest) {
+            std::cerr << "HttpOpenRequestA failed for URL: " << url << " Error: " << GetLastError() << std::endl;
+            return "";
+        }
+        if (!HttpSendRequestA(hRequest, NULL, 0, NULL, 0)) {
+            std::cerr << "HttpSendRequestA failed for URL: " << url << " Error: " << GetLastError() << std::endl;
+            InternetCloseHandle(hRequest);
+            return "";
+        }
+
+        DWORD status = 0;
+        DWORD statusSize = sizeof(status);
+        HttpQueryInfoA(hRequest, HTTP_QUERY_STATUS_CODE | HTTP_QUERY_FLAG_NUMBER, &status, &statusSize, NULL);
+
+        // Drain the whole body so the socket goes back to the keep-alive pool
+        std::string response;
+        char buffer[4096];
+        DWORD bytesRead;
+        while (InternetReadFile(hRequest, buffer, sizeof(buffer), &bytesRead) && bytesRead > 0) {
+            response.append(buffer, bytesRead);
+        }
+
+        InternetCloseHandle(hRequest);
+        if (status < 200 || status >= 300) {
+            std::cerr << "HTTP " << status << " for URL: " << url << std::endl;
+            return "";
+        }
+        return response;
+    }
+
+    // Issues all requests at once and returns the bodies in the same order.
+    // WinINet calls block, so they are spread over at most kMaxConnsPerServer
+    // workers; the caller waits for the slowest request, not the sum.
+    std::vector<std::string> getMany(const std::vector<std::string>& urls) override {
+        std::vector<std::string> responses(urls.size());
+        if (urls.size() == 1) {
+            responses[0] = get(urls[0]);
+            return responses;
+        }
+
+        std::atomic<size_t> next{0};
+        auto worker = [&]() {
+            for (size_t i = next++; i < urls.size(); i = next++)
+                responses[i] = get(urls[i]);
+        };
+        size_t workerCount = std::min<size_t>(urls.size(), kMaxConnsPerServer);
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < workerCount; i++) workers.emplace_back(worker);
+        for (auto& t : workers) t.join();
+        return responses;
+    }
+};